@@ -0,0 +1,105 @@
+// Times the physics update of the spatial hash interaction system for crowds of bodies, against testing every pair
+// of bodies, and against the budget of a 60 Hz frame.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "pixelengine/physics/SpatialHashInteractionSystem.h"
+
+using namespace pixelengine;
+using namespace pixelengine::physics;
+
+namespace {
+
+using benchmark_clock_t = std::chrono::steady_clock;
+
+constexpr float frame_budget_ms = 1000.f / 60.f;
+
+//! \brief Exposes the physics update, which the scene normally runs.
+class BenchmarkSystem : public SpatialHashInteractionSystem {
+public:
+  void Step(float dt) { _updatePhysics(dt, nullptr /* No world */); }
+};
+
+//! \brief Create bodies the size of the player scattered over a square, dense enough that many of them overlap.
+std::vector<std::unique_ptr<PhysicsBody>> makeCrowd(std::size_t count, std::mt19937& generator) {
+  constexpr unsigned width = 8, height = 16;
+  const auto side = static_cast<long long>(std::sqrt(static_cast<double>(count * width * height) * 2.));
+  std::uniform_int_distribution<long long> position(0, side);
+
+  std::vector<std::unique_ptr<PhysicsBody>> bodies;
+  bodies.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    bodies.push_back(std::make_unique<PhysicsBody>(PVec2 {position(generator), position(generator)}, width, height));
+  }
+  return bodies;
+}
+
+//! \brief Count the overlapping pairs by testing every pair of bodies, the work the broadphase avoids.
+std::size_t countOverlapsAllPairs(const std::vector<std::unique_ptr<PhysicsBody>>& bodies) {
+  std::size_t overlaps = 0;
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    auto a = bodies[i]->GetPosition();
+    for (std::size_t j = i + 1; j < bodies.size(); ++j) {
+      auto b = bodies[j]->GetPosition();
+      overlaps += a.x < b.x + bodies[j]->GetWidth() && b.x < a.x + bodies[i]->GetWidth()
+               && a.y < b.y + bodies[j]->GetHeight() && b.y < a.y + bodies[i]->GetHeight();
+    }
+  }
+  return overlaps;
+}
+
+template<typename Func_t>
+float timeMs(Func_t&& func) {
+  auto start = benchmark_clock_t::now();
+  func();
+  return std::chrono::duration<float, std::milli>(benchmark_clock_t::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+  constexpr std::size_t num_steps = 60;
+  std::mt19937 generator(0x5EED);
+
+  std::cout << std::setw(8) << "bodies" << std::setw(16) << "first step ms" << std::setw(16) << "mean step ms"
+            << std::setw(16) << "max step ms" << std::setw(16) << "all pairs ms" << std::setw(12) << "contacts"
+            << std::setw(14) << "fits 60 Hz" << "\n";
+
+  for (std::size_t count : {1000, 2000, 4000, 8000, 16000}) {
+    auto bodies = makeCrowd(count, generator);
+    BenchmarkSystem system;
+    for (auto& body : bodies) {
+      system.AddMember(body.get());
+    }
+
+    // The first step resolves all the overlaps of the crowd, later steps find the contacts that remain.
+    auto first_ms = timeMs([&] { system.Step(1.f / 60.f); });
+    float total_ms = 0.f, max_ms = 0.f;
+    for (std::size_t step = 0; step < num_steps; ++step) {
+      auto ms  = timeMs([&] { system.Step(1.f / 60.f); });
+      total_ms += ms;
+      max_ms    = std::max(max_ms, ms);
+    }
+    std::size_t overlaps = 0;
+    auto all_pairs_ms    = timeMs([&] { overlaps = countOverlapsAllPairs(bodies); });
+
+    std::cout << std::setw(8) << count << std::fixed << std::setprecision(3) << std::setw(16) << first_ms
+              << std::setw(16) << total_ms / num_steps << std::setw(16) << max_ms << std::setw(16) << all_pairs_ms
+              << std::setw(12) << system.GetContacts().size() << std::setw(14)
+              << (max_ms < frame_budget_ms ? "yes" : "no") << "\n";
+
+    // Members must leave the system before they are destroyed.
+    for (auto& body : bodies) {
+      system.QueueRemoveMember(body.get());
+    }
+    system.Step(1.f / 60.f);
+    // The all pairs count only keeps the loop from being optimized away.
+    if (overlaps == static_cast<std::size_t>(-1)) {
+      return 1;
+    }
+  }
+  return 0;
+}
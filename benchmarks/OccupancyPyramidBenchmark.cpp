@@ -0,0 +1,128 @@
+// Times casting long rays through large open caverns with the occupancy pyramid, which skips whole empty blocks,
+// against stepping through the grid square by square.
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+
+#include "pixelengine/world/OccupancyPyramid.h"
+
+using namespace pixelengine;
+using namespace pixelengine::world;
+
+namespace {
+
+using benchmark_clock_t = std::chrono::steady_clock;
+
+//! \brief A world of rock with one large cavern carved out of it, dotted with a few pillars.
+class CavernWorld : public World {
+public:
+  CavernWorld(long long width, long long height, std::size_t num_pillars, std::mt19937& generator)
+      : width_(width)
+      , height_(height)
+      , squares_(static_cast<std::size_t>(width * height), Square(true, Color(), &DIRT, nullptr)) {
+    const long long wall = 16;
+    for (auto y = wall; y < height_ - wall; ++y) {
+      for (auto x = wall; x < width_ - wall; ++x) {
+        getSquare(x, y) = Square();
+      }
+    }
+    std::uniform_int_distribution<long long> x_distribution(wall, width_ - wall - 8);
+    std::uniform_int_distribution<long long> y_distribution(wall, height_ - wall - 32);
+    for (std::size_t i = 0; i < num_pillars; ++i) {
+      auto px = x_distribution(generator), py = y_distribution(generator);
+      for (auto y = py; y < py + 32; ++y) {
+        for (auto x = px; x < px + 8; ++x) {
+          getSquare(x, y) = Square(true, Color(), &DIRT, nullptr);
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] float GetGravity() const override { return 0.f; }
+
+private:
+  [[nodiscard]] const Square& getSquare(long long x, long long y) const override {
+    return squares_[static_cast<std::size_t>(y * width_ + x)];
+  }
+
+  [[nodiscard]] Square& getSquare(long long x, long long y) override {
+    return squares_[static_cast<std::size_t>(y * width_ + x)];
+  }
+
+  void setSquare(long long x, long long y, const Square& square) override { getSquare(x, y) = square; }
+
+  [[nodiscard]] bool isValidSquare(long long x, long long y) const override {
+    return 0 <= x && x < width_ && 0 <= y && y < height_;
+  }
+
+  long long width_, height_;
+  std::vector<Square> squares_;
+};
+
+template<typename Func_t>
+float timeMs(Func_t&& func) {
+  auto start = benchmark_clock_t::now();
+  func();
+  return std::chrono::duration<float, std::milli>(benchmark_clock_t::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+  constexpr long long width = 4096, height = 2048;
+  constexpr std::size_t num_rays = 20000;
+  std::mt19937 generator(0x5EED);
+
+  std::cout << std::setw(10) << "pillars" << std::setw(12) << "length" << std::setw(16) << "squares ms"
+            << std::setw(16) << "pyramid ms" << std::setw(12) << "speedup" << std::setw(14) << "mismatches"
+            << "\n";
+
+  for (std::size_t num_pillars : {0, 200, 2000}) {
+    CavernWorld world(width, height, num_pillars, generator);
+    OccupancyPyramid pyramid(width, height);
+    pyramid.Update(world);
+
+    for (float max_distance : {64.f, 512.f, 4096.f}) {
+      // Rays start anywhere in the cavern, in any direction.
+      std::uniform_real_distribution<float> x_distribution(16.f, width - 16.f), y_distribution(16.f, height - 16.f);
+      std::uniform_real_distribution<float> angle_distribution(0.f, 2.f * std::numbers::pi_v<float>);
+      std::vector<RaySegment> rays(num_rays);
+      for (auto& ray : rays) {
+        auto angle = angle_distribution(generator);
+        ray        = {{x_distribution(generator), y_distribution(generator)},
+                      {std::cos(angle), std::sin(angle)},
+                      max_distance};
+      }
+
+      std::vector<RayHit> square_hits(num_rays), pyramid_hits(num_rays);
+      auto squares_ms = timeMs([&] {
+        for (std::size_t i = 0; i < num_rays; ++i) {
+          square_hits[i] = CastRay(world, rays[i]);
+        }
+      });
+      auto pyramid_ms = timeMs([&] {
+        for (std::size_t i = 0; i < num_rays; ++i) {
+          pyramid_hits[i] = pyramid.CastRay(rays[i]);
+        }
+      });
+
+      // The casts can disagree on rays that graze the corner of an occupied square, where rounding decides which
+      // square the ray enters first.
+      std::size_t mismatches = 0;
+      for (std::size_t i = 0; i < num_rays; ++i) {
+        mismatches += square_hits[i].is_hit != pyramid_hits[i].is_hit
+                   || (square_hits[i].is_hit && square_hits[i].square != pyramid_hits[i].square);
+      }
+
+      std::cout << std::setw(10) << num_pillars << std::fixed << std::setprecision(0) << std::setw(12)
+                << max_distance << std::setprecision(3) << std::setw(16) << squares_ms << std::setw(16)
+                << pyramid_ms << std::setprecision(2) << std::setw(12) << squares_ms / pyramid_ms << std::setw(14)
+                << mismatches << "\n";
+    }
+  }
+  return 0;
+}
@@ -20,6 +20,18 @@ using pixelengine::world::DIRT;
 using pixelengine::world::WATER;
 using pixelengine::world::Square;
 
+inline constexpr pixelengine::world::Material GOLD {.mass              = 4.0,
+                                                   .is_rigid          = true,
+                                                   .phase_of_matter   = pixelengine::world::PhaseOfMatter::SOLID,
+                                                   .light_attenuation = 0.3f};
+
+inline constexpr pixelengine::world::Material LAVA {.mass              = 2.5,
+                                                   .max_speed         = 50.0,
+                                                   .is_rigid          = false,
+                                                   .phase_of_matter   = pixelengine::world::PhaseOfMatter::LIQUID,
+                                                   .light_emission    = 0.9f,
+                                                   .light_attenuation = 0.15f};
+
 constexpr pixelengine::Color SAND_COLORS[] = {
   pixelengine::Color(204, 171, 114),
   pixelengine::Color(200, 168, 113),
@@ -27,6 +39,20 @@ constexpr pixelengine::Color SAND_COLORS[] = {
   pixelengine::Color(179, 149, 100),
 };
 
+constexpr pixelengine::Color GOLD_COLORS[] = {
+  pixelengine::Color(212, 175, 55),
+  pixelengine::Color(230, 190, 70),
+  pixelengine::Color(184, 150, 46),
+  pixelengine::Color(201, 164, 58),
+};
+
+constexpr pixelengine::Color LAVA_COLORS[] = {
+  pixelengine::Color(255, 96, 16),
+  pixelengine::Color(240, 70, 10),
+  pixelengine::Color(255, 140, 30),
+  pixelengine::Color(220, 50, 8),
+};
+
 // A background color.
 constexpr pixelengine::Color BACKGROUND(240, 228, 228);
 
@@ -3,8 +3,11 @@
 #include "minesandmagic/Materials.h"
 #include "minesandmagic/Player.h"
 #include "minesandmagic/SingleChunkWorld.h"
+#include "minesandmagic/Wanderer.h"
+#include "minesandmagic/WorldGeneration.h"
 #include "pixelengine/graphics/ShaderStore.h"
 #include "pixelengine/input/Input.h"
+#include "pixelengine/physics/SpatialHashInteractionSystem.h"
 #include "pixelengine/storage/LoadImage.h"
 #include "pixelengine/utility/Contracts.h"
 
@@ -18,24 +21,26 @@ void MinesAndMagic::setup() {
 
   auto world = std::make_unique<SingleChunkWorld>(texture_width_, texture_height_);
   world->SetName("World");
-
-  // Setup the materials in the world.
-  for (auto j = 0u; j < world->GetHeight() / 2; ++j) {
-    for (auto i = 0u; i < world->GetWidth(); ++i) {
-      auto r = randf();
-      if (r < 0.8) {
-        auto c = randf();
-        Square sand_square(true, SAND_COLORS[static_cast<int>(4 * c)], &SAND, &falling);
-        world->SetSquare(i, j, sand_square);
-      }
-      else {
-        world->SetSquare(i, j, Square(false, BACKGROUND, &AIR, nullptr));
-      }
-    }
-  }
+  const BoundingBox whole_world(0,
+                                static_cast<long long>(world->GetWidth()) - 1,
+                                0,
+                                static_cast<long long>(world->GetHeight()) - 1);
+
+  // Generate the materials in the world, in parallel, reusing chunks generated by earlier runs.
+  RegisterGeneratedSquares(palette_);
+  world_generator_ = MakeWorldGenerator(seed_, 64, static_cast<long long>(world->GetHeight()));
+  world_generator_->SetCache(std::make_unique<ChunkCache>(
+      std::filesystem::temp_directory_path() / "minesandmagic" / "chunks", &palette_));
+  world_generator_->GenerateInto(*world, whole_world, utility::JobSystem::Global());
+
+  // The world texture is stretched over the whole window, the same mapping the brush uses for the cursor, so the
+  // view shows every square of the world.
+  world->SetVisibleRegion(whole_world);
 
   auto player = std::make_unique<Player>(PVec2 {50, 180}, 8, 16);
   player->SetName("Player");
+  // Keep the simulation around the player responsive, even when the world is very active.
+  world->SetFocus(player.get());
 
   auto program = graphics::ShaderStore::GetInstance()->GetShaderProgram("TextureShader");
   PIXEL_ASSERT(program, "could not get shader program");
@@ -60,8 +65,30 @@ void MinesAndMagic::setup() {
   // Give the sprite a texture.
   player->AddChild(std::move(sprite));
 
+  // The player and the characters walking around the world push one another instead of passing through.
+  auto interactions = std::make_unique<physics::SpatialHashInteractionSystem>();
+  interactions->SetName("Interactions");
+  interactions->AddMember(player.get());
   world->AddChild(std::move(player));
 
+  for (long long x : {120, 220, 320}) {
+    auto wanderer = std::make_unique<Wanderer>(PVec2 {x, 180}, 8, 12);
+    wanderer->SetName("Wanderer");
+
+    auto wanderer_texture = std::make_unique<graphics::TextureBitmapOwning>(1, 1, program->GetDevice());
+    wanderer_texture->GetTextureBitmap().SetAllPixels(Color(40, 160, 60, 255));
+    auto wanderer_sprite =
+        std::make_unique<graphics::RectangularDrawable>(program, 8, 12, std::move(wanderer_texture));
+    wanderer_sprite->SetName("WandererSprite");
+    wanderer->AddChild(std::move(wanderer_sprite));
+
+    interactions->AddMember(wanderer.get());
+    world->AddChild(std::move(wanderer));
+  }
+
+  // After the bodies, so contacts are resolved once the bodies have moved.
+  world->AddChild(std::move(interactions));
+
   // Add the world as a child of the game.
   addNode(std::move(world));
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "pixelengine/application/Game.h"
+#include "pixelengine/world/WorldGenerator.h"
 
 namespace minesandmagic {
 
@@ -12,16 +13,26 @@ class MinesAndMagic : public pixelengine::app::Game {
 public:
   MinesAndMagic(uint32_t texture_width,
                 uint32_t texture_height,
-                const pixelengine::Dimensions& window_dimensions)
+                const pixelengine::Dimensions& window_dimensions,
+                uint64_t seed = 0x5EED)
       : Game(window_dimensions)
       , texture_width_(texture_width)
-      , texture_height_(texture_height) {}
+      , texture_height_(texture_height)
+      , seed_(seed) {}
 
 private:
   void setup() override;
 
   uint32_t texture_width_;
   uint32_t texture_height_;
+
+  //! \brief The seed that the world is generated from.
+  uint64_t seed_;
+
+  //! \brief The squares that generated chunks can be made of, used for caching chunks on disk.
+  pixelengine::world::SquarePalette palette_;
+
+  std::unique_ptr<pixelengine::world::WorldGenerator> world_generator_;
 };
 
 }  // namespace minesandmagic
\ No newline at end of file
@@ -4,10 +4,15 @@
 
 #include "minesandmagic/SingleChunkWorld.h"
 // Other files.
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
 #include "minesandmagic/Materials.h"
 #include "pixelengine/graphics/ShaderStore.h"
 #include "pixelengine/input/Input.h"
 #include "pixelengine/utility/Contracts.h"
+#include "pixelengine/utility/JobSystem.h"
 
 using namespace pixelengine;
 
@@ -16,8 +21,20 @@ namespace minesandmagic {
 SingleChunkWorld::SingleChunkWorld(std::size_t chunk_width, std::size_t chunk_height)
     : chunk_width_(chunk_width)
     , chunk_height_(chunk_height)
-    , active_region_(0, static_cast<long long>(chunk_width), 0, static_cast<long long>(chunk_height))
+    , tiles_x_((chunk_width + tile_size_ - 1) / tile_size_)
+    , tiles_y_((chunk_height + tile_size_ - 1) / tile_size_)
+    , tiles_(tiles_x_ * tiles_y_)
+    , change_tracker_(chunk_width, chunk_height, 32)
+    , light_map_(chunk_width, chunk_height)
+    , distance_field_(chunk_width, chunk_height)
+    , occupancy_(chunk_width, chunk_height)
+    , square_counts_(chunk_width, chunk_height, 32)
     , squares_(chunk_width_ * chunk_height_) {
+  // Everything starts out needing an update.
+  for (std::size_t i = 0; i < tiles_.size(); ++i) {
+    tiles_[i].active_region = getTileBounds(i);
+  }
+
   auto shader_program = graphics::ShaderStore::GetInstance()->GetShaderProgram("TextureShader");
   PIXEL_ASSERT(shader_program, "could not get shader program");
 
@@ -35,44 +52,150 @@ SingleChunkWorld::SingleChunkWorld(std::size_t chunk_width, std::size_t chunk_he
   drawable->SetName("WorldTexture");
 
   AddChild(std::move(drawable));
+
+  // Airborne squares are simulated by the particle system, and land back in the world.
+  auto particles = std::make_unique<ParticleSystem>(Square(false, BACKGROUND, &AIR, nullptr));
+  particles->SetName("Particles");
+  particles_ = particles.get();
+  AddChild(std::move(particles));
 }
 
 
-void SingleChunkWorld::_draw([[maybe_unused]] MTL::RenderCommandEncoder* render_command_encoder) {
-  // Update pixels to render the world.
-  for (auto j = 0ull; j < world_texture_.GetHeight(); ++j) {
-    for (auto i = 0ull; i < world_texture_.GetWidth(); ++i) {
-      auto x        = i;
-      auto y        = world_texture_.GetHeight() - 1 - j;
-      auto&& square = GetSquare(i, j);
-
-      world_texture_.SetPixel(x, y, square.color);
+void SingleChunkWorld::copyToPlane(node::RenderSnapshot::ColorPlane& plane) const {
+  std::ranges::transform(
+      squares_, plane.pixels.begin(), [](const Square& square) { return std::bit_cast<std::uint32_t>(square.color); });
+  std::ranges::copy(light_map_.GetLevels(), plane.levels.begin());
+  // Airborne particles are drawn over the squares, and are not shaded.
+  for (std::size_t i = 0; i < particles_->Size(); ++i) {
+    auto position = particles_->GetPosition(i);
+    auto x        = static_cast<long long>(std::floor(position.x));
+    auto y        = static_cast<long long>(std::floor(position.y));
+    if (isValidSquare(x, y)) {
+      auto index          = static_cast<std::size_t>(y) * chunk_width_ + static_cast<std::size_t>(x);
+      plane.pixels[index] = std::bit_cast<std::uint32_t>(particles_->GetColor(i));
+      plane.levels[index] = 255;
+    }
+  }
+}
+
+void SingleChunkWorld::drawPlane(const node::RenderSnapshot::ColorPlane& plane) {
+  PIXEL_ASSERT(plane.width == world_texture_.GetWidth() && plane.height == world_texture_.GetHeight()
+                   && plane.levels.size() == plane.pixels.size(),
+               "the plane must be the size of the world, with a light level for every square");
+  shaded_pixels_.resize(plane.pixels.size());
+  for (std::size_t j = 0; j < plane.height; ++j) {
+    const auto row     = j * plane.width;
+    const auto out_row = (plane.height - 1 - j) * plane.width;
+    for (std::size_t i = 0; i < plane.width; ++i) {
+      // Shade the square by how much light reaches it.
+      auto light  = static_cast<unsigned>(plane.levels[row + i]);
+      auto color  = std::bit_cast<Color>(plane.pixels[row + i]);
+      color.red   = static_cast<uint8_t>(color.red * light / 255);
+      color.green = static_cast<uint8_t>(color.green * light / 255);
+      color.blue  = static_cast<uint8_t>(color.blue * light / 255);
+      shaded_pixels_[out_row + i] = std::bit_cast<std::uint32_t>(color);
     }
   }
+  world_texture_.SetPixels(shaded_pixels_);
   // Update the metal texture behind the texture bitmap.
   world_texture_.Update();
 }
 
+void SingleChunkWorld::_draw([[maybe_unused]] MTL::RenderCommandEncoder* render_command_encoder) {
+  live_plane_.Resize(chunk_width_, chunk_height_, true);
+  copyToPlane(live_plane_);
+  drawPlane(live_plane_);
+}
+
+void SingleChunkWorld::_snapshot(node::RenderSnapshot& snapshot) const {
+  // Only copy the world here, so the simulation is held up as little as possible. It is shaded while drawing.
+  copyToPlane(snapshot.AddPlane(chunk_width_, chunk_height_, true));
+}
+
+void SingleChunkWorld::_drawSnapshot([[maybe_unused]] MTL::RenderCommandEncoder* render_command_encoder,
+                                     const node::RenderSnapshot& snapshot,
+                                     const node::RenderSnapshot::NodeState& state) {
+  // Only the render thread touches the texture, so it can be filled while the simulation runs.
+  if (auto* plane = snapshot.GetPlane(state)) {
+    drawPlane(*plane);
+  }
+}
+
 void SingleChunkWorld::_updatePhysics(float raw_dt, [[maybe_unused]] const world::World* world) {
-  auto dt = std::min(1.f / 30.f, raw_dt);
+  using physics_clock_t = std::chrono::high_resolution_clock;
+  const auto start_time = physics_clock_t::now();
+  ++tick_;
 
-  // Reset was-moved flags.
-  for (auto y = 0; y < static_cast<long long>(chunk_height_); ++y) {
-    for (auto x = 0; x < static_cast<long long>(chunk_width_); ++x) {
-      auto&& square    = getSquare(x, y);
-      square.num_moves = 0;
+  // Every active tile accumulates time, whether or not it gets simulated during this update. A tile that came to
+  // rest has nothing left to catch up on. The time is capped at the longest a tile should wait, and the rest is
+  // dropped: a tile only advances by max_time_step_ per update, so under sustained load it could never pay back an
+  // unbounded debt. Once a starved tile runs, it drops back below max_tile_wait_, so it does not keep the top rank.
+  std::vector<std::pair<unsigned, std::size_t>> schedule;
+  for (std::size_t i = 0; i < tiles_.size(); ++i) {
+    if (tiles_[i].active_region.IsEmpty()) {
+      tiles_[i].pending_dt = 0.f;
+      continue;
+    }
+    tiles_[i].pending_dt = std::min(tiles_[i].pending_dt + raw_dt, max_tile_wait_);
+    schedule.emplace_back(getTilePriority(i), i);
+  }
+  // Tiles are ordered by priority, and then from the bottom of the world to the top, the same order that rows
+  // are updated in. So a square falling into a lower tile of the same priority is not updated twice. A square
+  // falling into a lower tile with a worse priority can be updated again when that tile runs later in this update.
+  std::ranges::sort(schedule);
+
+  // The regions that will need to be updated during the next physics update.
+  std::vector<BoundingBox> next_active(tiles_.size());
+
+  bool is_first = true;
+  for (auto [priority, index] : schedule) {
+    // Always make some progress, even if a single tile is over budget.
+    std::chrono::duration<float> elapsed = physics_clock_t::now() - start_time;
+    if (!is_first && physics_time_budget_ < elapsed.count()) {
+      break;
     }
+    is_first = false;
+
+    // A tile that accumulated more than the largest step keeps the rest, and catches up over the next updates.
+    auto& tile  = tiles_[index];
+    auto dt     = std::min(max_time_step_, tile.pending_dt);
+    auto region = tile.active_region.Intersection(getTileBounds(index));
+    tile.pending_dt -= dt;
+    tile.active_region = {};
+
+    updateRegion(region, dt, next_active);
   }
 
-  // Get the region in which updates need to occur.
-  active_region_.Expand(1);
-  auto [x_min, x_max, y_min, y_max] =
-      active_region_.Clip(static_cast<long long>(chunk_width_), static_cast<long long>(chunk_height_));
+  // Deferred tiles keep their region (and accumulated time), and gain anything that moved into them.
+  for (std::size_t i = 0; i < tiles_.size(); ++i) {
+    tiles_[i].active_region.Update(next_active[i]);
+  }
+
+  // Relight whatever changed, and update the derived views of the terrain.
+  light_map_.Update(*this, utility::JobSystem::Global());
+  distance_field_.Update(*this, utility::JobSystem::Global());
+  occupancy_.Update(*this);
+  square_counts_.Update(*this);
+
+  // TODO: Other updates, e.g. temperature, objects catching fire, reacting, etc.?
+}
 
-  // BB for determining the next active zone.
-  BoundingBox bounding_box;
+void SingleChunkWorld::updateRegion(const BoundingBox& region,
+                                    float dt,
+                                    std::vector<BoundingBox>& next_active) {
+  if (region.IsEmpty()) {
+    return;
+  }
+  auto [x_min, x_max, y_min, y_max] = region;
 
-  auto update = [this, dt, &bounding_box](long long x, long long y) {
+  // Reset was-moved flags.
+  for (auto y = y_min; y <= y_max; ++y) {
+    for (auto x = x_min; x <= x_max; ++x) {
+      getSquare(x, y).num_moves = 0;
+    }
+  }
+
+  auto update = [this, dt, &next_active](long long x, long long y) {
     auto&& square = getSquare(x, y);
     if (!square.is_occupied || square.material->is_rigid || !square.behavior /* || 0 < square.num_moves*/) {
       return;
@@ -80,7 +203,8 @@ void SingleChunkWorld::_updatePhysics(float raw_dt, [[maybe_unused]] const world
 
     square.UpdateKinematics(dt, *this);
     if (auto bb = square.behavior->Update(dt, x, y, *this); !bb.IsEmpty()) {
-      bounding_box.Update(bb);
+      change_tracker_.MarkChanged(bb);
+      markActive(bb, [&](std::size_t index, const BoundingBox& part) { next_active[index].Update(part); });
     }
   };
 
@@ -97,11 +221,60 @@ void SingleChunkWorld::_updatePhysics(float raw_dt, [[maybe_unused]] const world
       }
     }
   }
+}
 
-  // Update active region.
-  active_region_ = bounding_box;
+BoundingBox SingleChunkWorld::getTileBounds(std::size_t tile_index) const {
+  auto tx = static_cast<long long>(tile_index % tiles_x_);
+  auto ty = static_cast<long long>(tile_index / tiles_x_);
+  return {tx * tile_size_,
+          std::min((tx + 1) * tile_size_, static_cast<long long>(chunk_width_)) - 1,
+          ty * tile_size_,
+          std::min((ty + 1) * tile_size_, static_cast<long long>(chunk_height_)) - 1};
+}
 
-  // TODO: Other updates, e.g. temperature, objects catching fire, reacting, etc.?
+unsigned SingleChunkWorld::getTilePriority(std::size_t tile_index) const {
+  auto& tile = tiles_[tile_index];
+  if (max_tile_wait_ <= tile.pending_dt) {
+    return 0;
+  }
+  auto bounds = getTileBounds(tile_index);
+
+  const bool is_visible = !bounds.Intersection(visible_region_).IsEmpty();
+
+  bool is_near_focus = false;
+  if (focus_) {
+    auto position = focus_->GetPosition();
+    auto near     = bounds;
+    near.Expand(focus_radius_);
+    is_near_focus = near.Contains(position.x, position.y);
+  }
+
+  const bool is_recently_edited =
+      tile.last_edit_tick.has_value() && tick_ <= *tile.last_edit_tick + recent_edit_ticks_;
+
+  // Visibility dominates, then proximity to the focus, then recent edits.
+  return 1 + (is_visible ? 0 : 4) + (is_near_focus ? 0 : 2) + (is_recently_edited ? 0 : 1);
+}
+
+void SingleChunkWorld::setSquare(long long x, long long y, const Square& square) {
+  getSquare(x, y) = square;
+  markEdited(BoundingBox(x, x, y, y));
+}
+
+void SingleChunkWorld::markEdited(const BoundingBox& region) {
+  change_tracker_.MarkChanged(region);
+  markActive(region, [this](std::size_t index, const BoundingBox& part) {
+    tiles_[index].active_region.Update(part);
+    tiles_[index].last_edit_tick = tick_;
+  });
+}
+
+BoundingBox SingleChunkWorld::GetActiveRegion() const {
+  BoundingBox active_region;
+  for (auto& tile : tiles_) {
+    active_region.Update(tile.active_region);
+  }
+  return active_region;
 }
 
 void SingleChunkWorld::_update([[maybe_unused]] float dt) {
@@ -109,54 +282,57 @@ void SingleChunkWorld::_update([[maybe_unused]] float dt) {
   // TODO: Use input callbacks instead?
   if (input::Input::IsJustPressed('B')) {
     brush_type += 1;
-    brush_type = brush_type % 3;
+    brush_type = brush_type % 4;
     LOG_SEV(Debug) << "Changed brush type to " << brush_type;
   }
 
   // Update the world based on input.
 
-  if (input::Input::IsLeftMousePressed()) {
-    if (auto opt = input::Input::GetApplicationCursorPosition()) {
-      auto [fx, fy] = *opt;
-
-      auto x = static_cast<long long>(fx * chunk_width_);
-      auto y = static_cast<long long>(fy * chunk_height_);
-
-      // Generate randomly in a circle
-      int radius = 10;
-      float p    = 0.7;  // 0.7
-      for (int i = -radius; i <= radius; ++i) {
-        for (int j = -radius; j <= radius; ++j) {
-          if (i * i + j * j <= radius * radius) {
-            if (!IsValidSquare(x + i, y + j)) {
-              continue;
-            }
-            if (GetSquare(x + i, y + j).is_occupied) {
-              continue;
-            }
-            if (randf() < p) {
-              auto c = randf();
-
-              Square square;
-
-              if (brush_type == 0) {
-                square            = Square(true, SAND_COLORS[static_cast<int>(4 * c)], &SAND, &falling);
-                square.velocity.y = -50;
-              }
-              else if (brush_type == 1) {
-                square            = Square(true, Color::FromFloats(0., 0., 1.), &WATER, &liquid);
-                square.velocity.y = -50;
-              }
-              else if (brush_type == 2) {
-                square = Square(true, Color(randi(30, 60), randi(30, 60), randi(30, 60)), &DIRT, &stationary);
-              }
-              SetSquare(x + i, y + j, square);
-            }
-          }
-        }
-      }
+  if (!input::Input::IsLeftMousePressed()) {
+    last_brush_position_ = {};
+    return;
+  }
+  auto opt = input::Input::GetApplicationCursorPosition();
+  if (!opt) {
+    last_brush_position_ = {};
+    return;
+  }
+  auto [fx, fy] = *opt;
+  PVec2 position {static_cast<long long>(fx * chunk_width_), static_cast<long long>(fy * chunk_height_)};
+
+  // Generate randomly along the stroke.
+  int radius = 10;
+  float p    = 0.7;  // 0.7
+  auto paint = [p](long long, long long, Square& square) {
+    if (square.is_occupied || p <= randf()) {
+      return;
     }
+    auto c = randf();
+    if (brush_type == 0) {
+      square            = Square(true, SAND_COLORS[static_cast<int>(4 * c)], &SAND, &falling);
+      square.velocity.y = -50;
+    }
+    else if (brush_type == 1) {
+      square            = Square(true, Color::FromFloats(0., 0., 1.), &WATER, &liquid);
+      square.velocity.y = -50;
+    }
+    else if (brush_type == 2) {
+      square = Square(true, Color(randi(30, 60), randi(30, 60), randi(30, 60)), &DIRT, &stationary);
+    }
+    else if (brush_type == 3) {
+      square            = Square(true, LAVA_COLORS[static_cast<int>(4 * c)], &LAVA, &liquid);
+      square.velocity.y = -50;
+    }
+  };
+
+  // Connect to where the brush was last frame, so fast strokes do not leave gaps.
+  if (last_brush_position_) {
+    StrokeLine(*last_brush_position_, position, radius, paint);
+  }
+  else {
+    FillCircle(position, radius, paint);
   }
+  last_brush_position_ = position;
 }
 
 
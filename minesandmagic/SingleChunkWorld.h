@@ -5,6 +5,13 @@
 #pragma once
 
 #include "pixelengine/graphics/RectangularDrawable.h"
+#include "pixelengine/physics/PhysicsBody.h"
+#include "pixelengine/world/ChangeTracker.h"
+#include "pixelengine/world/DistanceField.h"
+#include "pixelengine/world/LightMap.h"
+#include "pixelengine/world/OccupancyCounts.h"
+#include "pixelengine/world/OccupancyPyramid.h"
+#include "pixelengine/world/ParticleSystem.h"
 #include "pixelengine/world/World.h"
 
 namespace minesandmagic {
@@ -21,33 +28,188 @@ public:
   [[nodiscard]] std::size_t GetHeight() const { return chunk_height_; }
   [[nodiscard]] float GetGravity() const override { return gravity_; }
 
-  [[nodiscard]] const BoundingBox& GetActiveRegion() const { return active_region_; }
+  [[nodiscard]] const ChangeTracker* GetChangeTracker() const override { return &change_tracker_; }
+
+  [[nodiscard]] SquareCounts CountSquares(const BoundingBox& region) const override {
+    return square_counts_.Count(*this, region);
+  }
+
+  //! \brief Get a bounding box around all squares that still need to be updated.
+  [[nodiscard]] BoundingBox GetActiveRegion() const;
+
+  //! \brief Set the maximum amount of wall clock time, in seconds, that a single physics update may spend
+  //!        simulating squares. Tiles that do not fit into the budget are deferred to the next update.
+  void SetPhysicsTimeBudget(float seconds) { physics_time_budget_ = seconds; }
+
+  //! \brief Set the region of the world that is currently visible. Visible tiles are simulated first. Until a region
+  //!        is set, no tile counts as visible.
+  void SetVisibleRegion(const BoundingBox& region) { visible_region_ = region; }
+
+  //! \brief Set the body (e.g. the player) that tiles near to are simulated with higher priority.
+  void SetFocus(const pixelengine::physics::PhysicsBody* focus) { focus_ = focus; }
+
+  //! \brief Get the particle system that simulates squares flying through the air.
+  [[nodiscard]] ParticleSystem& GetParticles() { return *particles_; }
+
+  //! \brief Get the light levels of the world, which are updated after every physics update.
+  [[nodiscard]] LightMap& GetLightMap() { return light_map_; }
+
+  //! \brief Get the distance from every square to the solid terrain, which is updated after every physics update.
+  [[nodiscard]] const DistanceField& GetDistanceField() const { return distance_field_; }
+
+  //! \brief Get the pyramid of occupied blocks, for skipping empty space. Updated after every physics update.
+  [[nodiscard]] const OccupancyPyramid& GetOccupancy() const { return occupancy_; }
 
 private:
+  //! \brief A rectangular tile of the world that is scheduled for simulation as a unit.
+  struct UpdateTile {
+    //! \brief The squares within the tile that need to be updated.
+    BoundingBox active_region;
+
+    //! \brief Simulation time that the tile has not been advanced by yet, up to max_tile_wait_. Anything beyond that
+    //!        is dropped, so a tile that keeps being deferred never owes more time than it can catch up on.
+    float pending_dt = 0.f;
+
+    //! \brief The physics tick during which a square in the tile was last set, if it ever was.
+    std::optional<std::size_t> last_edit_tick {};
+  };
+
   void _update(float dt) override;
 
   void _updatePhysics(float dt, const World* world) override;
 
   void _draw(MTL::RenderCommandEncoder* render_command_encoder) override;
 
-  void setSquare(long long x, long long y, const Square& square) override {
-    active_region_.Update(x, y);
-    getSquare(x, y) = square;
+  void _snapshot(pixelengine::node::RenderSnapshot& snapshot) const override;
+
+  void _drawSnapshot(MTL::RenderCommandEncoder* render_command_encoder,
+                     const pixelengine::node::RenderSnapshot& snapshot,
+                     const pixelengine::node::RenderSnapshot::NodeState& state) override;
+
+  //! \brief Copy the color and light level of every square into a plane sized to the world, with the airborne
+  //!        particles drawn over them at full light. Nothing is shaded, so this is cheap enough for the simulation.
+  void copyToPlane(pixelengine::node::RenderSnapshot::ColorPlane& plane) const;
+
+  //! \brief Shade the squares of a plane by their light, and put them into the world texture, upside down, since the
+  //!        texture's rows go from the top of the world down.
+  void drawPlane(const pixelengine::node::RenderSnapshot::ColorPlane& plane);
+
+  void setSquare(long long x, long long y, const Square& square) override;
+
+  [[nodiscard]] std::span<Square> getSquareRow(long long x, long long y, long long count) override {
+    if (!isValidSquare(x, y)) {
+      return {};
+    }
+    auto length = std::min(count, static_cast<long long>(chunk_width_) - x);
+    return {&squares_[y * chunk_width_ + x], static_cast<std::size_t>(length)};
+  }
+
+  [[nodiscard]] std::span<const Square> getSquareRow(long long x, long long y, long long count) const override {
+    if (!isValidSquare(x, y)) {
+      return {};
+    }
+    auto length = std::min(count, static_cast<long long>(chunk_width_) - x);
+    return {&squares_[y * chunk_width_ + x], static_cast<std::size_t>(length)};
   }
 
+  void markEdited(const BoundingBox& region) override;
+
   [[nodiscard]] bool isValidSquare(long long x, long long y) const override {
     return 0 <= x && x < static_cast<long long>(chunk_width_) && 0 <= y && y < static_cast<long long>(chunk_height_);
   }
 
+  //! \brief Update all the squares in the region (which must be within the world).
+  void updateRegion(const BoundingBox& region, float dt, std::vector<BoundingBox>& next_active);
+
+  //! \brief Mark a region, and the squares bordering it, as needing an update. The callback is called with
+  //!        the index of every tile the region overlaps, and the part of the region within that tile.
+  template<typename Func_t>
+  void markActive(BoundingBox region, Func_t&& callback) const {
+    // Squares bordering a change may now be able to move.
+    region.Expand(1);
+    auto [x_min, x_max, y_min, y_max] =
+        region.Clip(static_cast<long long>(chunk_width_), static_cast<long long>(chunk_height_));
+    if (x_max < x_min || y_max < y_min) {
+      return;
+    }
+    BoundingBox clipped(x_min, x_max, y_min, y_max);
+    for (auto ty = y_min / tile_size_; ty <= y_max / tile_size_; ++ty) {
+      for (auto tx = x_min / tile_size_; tx <= x_max / tile_size_; ++tx) {
+        auto index = static_cast<std::size_t>(ty) * tiles_x_ + static_cast<std::size_t>(tx);
+        callback(index, clipped.Intersection(getTileBounds(index)));
+      }
+    }
+  }
+
+  //! \brief Get the bounds of a tile, in squares.
+  [[nodiscard]] BoundingBox getTileBounds(std::size_t tile_index) const;
+
+  //! \brief The scheduling rank of a tile. Lower ranks are simulated first.
+  [[nodiscard]] unsigned getTilePriority(std::size_t tile_index) const;
+
   std::size_t chunk_width_;
   std::size_t chunk_height_;
 
-  BoundingBox active_region_;
+  //! \brief The width and height of an update tile, in squares.
+  static constexpr long long tile_size_ = 64;
+
+  //! \brief Number of update tiles in the x and y directions.
+  std::size_t tiles_x_, tiles_y_;
+
+  std::vector<UpdateTile> tiles_;
+
+  //! \brief Number of physics updates that have occurred.
+  std::size_t tick_ = 0;
+
+  //! \brief Wall clock time budget per physics update, in seconds.
+  float physics_time_budget_ = 0.008f;
+
+  //! \brief The largest time step a tile will be advanced by at once, no matter how much time it accumulated.
+  float max_time_step_ = 1.f / 30.f;
+
+  //! \brief Tiles that have been waiting for longer than this many seconds are simulated before any others,
+  //!        so that no region of the world starves.
+  float max_tile_wait_ = 0.25f;
+
+  //! \brief How many ticks after being edited that a tile counts as recently edited.
+  std::size_t recent_edit_ticks_ = 60;
+
+  //! \brief How far, in squares, from the focus that a tile counts as being near the focus.
+  long long focus_radius_ = 96;
+
+  //! \brief The part of the world that the view shows.
+  BoundingBox visible_region_;
+
+  const pixelengine::physics::PhysicsBody* focus_ {};
+
+  //! \brief Where the brush was during the last update, if it was being used, so strokes are continuous.
+  std::optional<pixelengine::PVec2> last_brush_position_ {};
 
   //! \brief Acceleration due to gravity, in squares per second squared.
   float gravity_ = -100.;
 
-  mutable pixelengine::TextureBitmap world_texture_;
+  //! \brief The particle system, which is a child of the world.
+  ParticleSystem* particles_ {};
+
+  //! \brief Records which parts of the world changed, for systems that derive data from the squares.
+  ChangeTracker change_tracker_;
+
+  LightMap light_map_;
+
+  DistanceField distance_field_;
+
+  OccupancyPyramid occupancy_;
+
+  //! \brief Summed-area tables of the squares, rebuilt after every physics update.
+  OccupancyCounts square_counts_;
+
+  pixelengine::TextureBitmap world_texture_;
+
+  //! \brief The plane that drawing straight from the world copies into.
+  pixelengine::node::RenderSnapshot::ColorPlane live_plane_;
+
+  //! \brief The shaded pixels of the world texture. Only touched while drawing.
+  std::vector<std::uint32_t> shaded_pixels_;
   std::shared_ptr<pixelengine::graphics::RectangularDrawable> main_drawable_;
 
   Square& getSquare(long long x, long long y) override {
@@ -65,4 +227,4 @@ private:
 };
 
 
-}  // namespace minesandmagic
\ No newline at end of file
+}  // namespace minesandmagic
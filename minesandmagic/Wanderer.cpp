@@ -0,0 +1,21 @@
+#include "minesandmagic/Wanderer.h"
+// Other files.
+
+namespace minesandmagic {
+
+void Wanderer::_update(float dt) {
+  Node::_update(dt);
+
+  auto& state = GetState();
+  if (is_walking_right_ ? state.blocked_right : state.blocked_left) {
+    is_walking_right_ = !is_walking_right_;
+  }
+  setVelocityX(is_walking_right_ ? walking_speed_ : -walking_speed_);
+}
+
+void Wanderer::_onContactBegin(PhysicsBody* other) {
+  // Turn away from whatever was bumped into.
+  is_walking_right_ = other->GetPosition().x < GetPosition().x;
+}
+
+}  // namespace minesandmagic
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pixelengine/physics/PhysicsBody.h"
+
+namespace minesandmagic {
+
+using pixelengine::PVec2;
+
+//! \brief A non-player character that walks back and forth, turning around whenever the terrain or another body
+//!        blocks its way.
+class Wanderer : public pixelengine::physics::PhysicsBody {
+public:
+  Wanderer(PVec2 position, unsigned width, unsigned height) : PhysicsBody(position, width, height) {}
+
+private:
+  void _update(float dt) override;
+
+  void _onContactBegin(PhysicsBody* other) override;
+
+  //! \brief How fast the wanderer walks, in pixels per physics update.
+  float walking_speed_ = 0.5f;
+
+  bool is_walking_right_ = true;
+};
+
+}  // namespace minesandmagic
@@ -0,0 +1,123 @@
+#include "minesandmagic/WorldGeneration.h"
+// Other files.
+#include "minesandmagic/Materials.h"
+#include "pixelengine/utility/Noise.h"
+
+using namespace pixelengine;
+using namespace pixelengine::world;
+
+namespace minesandmagic {
+
+namespace {
+
+// Salts, so each stage draws from different random numbers for the same seed.
+constexpr uint64_t surface_salt = 0x51;
+constexpr uint64_t sand_salt    = 0x5A;
+constexpr uint64_t cave_salt    = 0xCA;
+constexpr uint64_t ore_salt     = 0x0E;
+constexpr uint64_t color_salt   = 0xC0;
+
+//! \brief Bump this when changing how any of the stages generate squares, so chunks cached by an older version of
+//!        the game are regenerated.
+constexpr long long generation_version = 1;
+
+//! \brief Pick one of the colors, fixed for a given position.
+template<std::size_t N>
+Color pickColor(uint64_t seed, long long x, long long y, const Color (&colors)[N]) {
+  return colors[math::HashCoordinates(seed ^ color_salt, x, y) % N];
+}
+
+Color dirtColor(uint64_t seed, long long x, long long y) {
+  auto hash = math::HashCoordinates(seed ^ color_salt, x, y);
+  return Color(30 + hash % 30, 30 + (hash >> 8) % 30, 30 + (hash >> 16) % 30);
+}
+
+}  // namespace
+
+void TerrainStage::Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const {
+  for (std::size_t i = 0; i < chunk.GetWidth(); ++i) {
+    auto x = origin.x + static_cast<long long>(i);
+
+    // The surface and sand depth only depend on the column.
+    auto surface_noise = math::FractalNoise(seed ^ surface_salt, static_cast<float>(x) / 96.f, 0.f, 4);
+    auto surface       = surface_height_ + static_cast<long long>(2.f * (surface_noise - 0.5f) * amplitude_);
+    auto sand_depth =
+        8 + static_cast<long long>(10.f * math::ValueNoise(seed ^ sand_salt, static_cast<float>(x) / 24.f, 0.f));
+
+    for (std::size_t j = 0; j < chunk.GetHeight(); ++j) {
+      auto y = origin.y + static_cast<long long>(j);
+      if (surface < y) {
+        chunk.SetSquare(i, j, Square(false, BACKGROUND, &AIR, nullptr));
+      }
+      else if (surface - sand_depth < y) {
+        chunk.SetSquare(i, j, Square(true, pickColor(seed, x, y, SAND_COLORS), &SAND, &falling));
+      }
+      else {
+        chunk.SetSquare(i, j, Square(true, dirtColor(seed, x, y), &DIRT, &stationary));
+      }
+    }
+  }
+}
+
+uint64_t TerrainStage::GetFingerprint() const {
+  auto stage = math::HashCoordinates(surface_salt, generation_version, 0);
+  return math::HashCoordinates(stage, surface_height_, amplitude_);
+}
+
+void CaveStage::Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const {
+  for (std::size_t j = 0; j < chunk.GetHeight(); ++j) {
+    for (std::size_t i = 0; i < chunk.GetWidth(); ++i) {
+      if (chunk.GetSquare(i, j).material != &DIRT) {
+        continue;
+      }
+      auto x = static_cast<float>(origin.x + static_cast<long long>(i));
+      auto y = static_cast<float>(origin.y + static_cast<long long>(j));
+      // Caves follow the contour where the noise crosses one half, which gives long, winding tunnels.
+      auto noise = math::FractalNoise(seed ^ cave_salt, x / 48.f, y / 32.f, 3);
+      if (std::abs(noise - 0.5f) < 0.035f) {
+        chunk.SetSquare(i, j, Square(false, BACKGROUND, &AIR, nullptr));
+      }
+    }
+  }
+}
+
+uint64_t CaveStage::GetFingerprint() const {
+  return math::HashCoordinates(cave_salt, generation_version, 0);
+}
+
+void OreStage::Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const {
+  for (std::size_t j = 0; j < chunk.GetHeight(); ++j) {
+    for (std::size_t i = 0; i < chunk.GetWidth(); ++i) {
+      if (chunk.GetSquare(i, j).material != &DIRT) {
+        continue;
+      }
+      auto x = origin.x + static_cast<long long>(i);
+      auto y = origin.y + static_cast<long long>(j);
+      auto noise = math::FractalNoise(seed ^ ore_salt, static_cast<float>(x) / 6.f, static_cast<float>(y) / 6.f, 2);
+      if (0.78f < noise) {
+        chunk.SetSquare(i, j, Square(true, pickColor(seed, x, y, GOLD_COLORS), &GOLD, &stationary));
+      }
+    }
+  }
+}
+
+uint64_t OreStage::GetFingerprint() const {
+  return math::HashCoordinates(ore_salt, generation_version, 0);
+}
+
+void RegisterGeneratedSquares(SquarePalette& palette) {
+  palette.Register(&AIR, nullptr);
+  palette.Register(&SAND, &falling);
+  palette.Register(&DIRT, &stationary);
+  palette.Register(&GOLD, &stationary);
+}
+
+std::unique_ptr<WorldGenerator> MakeWorldGenerator(uint64_t seed, std::size_t chunk_size, long long world_height) {
+  auto generator = std::make_unique<WorldGenerator>(seed, chunk_size);
+  generator->AddStage(std::make_unique<TerrainStage>(world_height / 2, world_height / 10));
+  generator->AddStage(std::make_unique<CaveStage>());
+  generator->AddStage(std::make_unique<OreStage>());
+  return generator;
+}
+
+}  // namespace minesandmagic
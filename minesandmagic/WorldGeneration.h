@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pixelengine/world/WorldGenerator.h"
+
+namespace minesandmagic {
+
+using pixelengine::PVec2;
+using pixelengine::world::GenerationStage;
+using pixelengine::world::Prefab;
+
+//! \brief Fills a chunk with air above a rolling surface, a layer of sand just below it, and dirt underneath.
+class TerrainStage : public GenerationStage {
+public:
+  //! \param surface_height The average height of the surface, in squares.
+  //! \param amplitude How far the surface deviates from the average height, in squares.
+  TerrainStage(long long surface_height, long long amplitude)
+      : surface_height_(surface_height)
+      , amplitude_(amplitude) {}
+
+  void Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const override;
+
+  [[nodiscard]] uint64_t GetFingerprint() const override;
+
+private:
+  long long surface_height_;
+  long long amplitude_;
+};
+
+//! \brief Carves winding caves out of the dirt.
+class CaveStage : public GenerationStage {
+public:
+  void Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const override;
+
+  [[nodiscard]] uint64_t GetFingerprint() const override;
+};
+
+//! \brief Places veins of gold in the dirt.
+class OreStage : public GenerationStage {
+public:
+  void Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const override;
+
+  [[nodiscard]] uint64_t GetFingerprint() const override;
+};
+
+//! \brief Register every (material, behavior) pair that generated squares use.
+void RegisterGeneratedSquares(pixelengine::world::SquarePalette& palette);
+
+//! \brief Create the generator for the game's world.
+std::unique_ptr<pixelengine::world::WorldGenerator> MakeWorldGenerator(uint64_t seed,
+                                                                       std::size_t chunk_size,
+                                                                       long long world_height);
+
+}  // namespace minesandmagic
@@ -6,6 +6,9 @@
 // Other files.
 #include "pixelengine/graphics/ShaderStore.h"
 #include "pixelengine/input/Input.h"
+#include "pixelengine/node/HitIndex.h"
+#include "pixelengine/physics/BodyStore.h"
+#include "pixelengine/utility/JobSystem.h"
 
 using game_clock_t = std::chrono::high_resolution_clock;
 
@@ -58,6 +61,8 @@ void Game::Run() {
     // Run the world simulation in a separate thread. `is_running_` is used to synchronize.
     simulation_thread_ = std::thread(simulation, this);
     application->run();
+    is_running_ = false;
+    simulation_thread_.join();
   }
   else {
     is_running_ = true;
@@ -76,40 +81,140 @@ void Game::update(float delta) {
   // Update the input object.
   input::Input::Update(application_->GetFrame());
 
-  scene_->removeQueuedChildren();
+  if (usesSnapshots()) {
+    // Snapshots the renderer has not finished with may still refer to removed nodes.
+    std::vector<std::unique_ptr<Node>> removed;
+    scene_->removeQueuedChildren(&removed);
+    for (auto& node : removed) {
+      retired_nodes_.emplace_back(next_snapshot_, std::move(node));
+    }
+  }
+  else {
+    scene_->removeQueuedChildren();
+  }
   scene_->addQueuedChildren();
 
   auto id = math::Transformation2D::Identity();
   scene_->updateTransformation(false, id);
 
-  // Check all input signals.
+  // Find the nodes this frame's input could hit: those under the cursor, and those inside a drag that just ended.
+  auto& hit_index = node::HitIndex::Global();
+  hit_index.BeginFrame(input::Input::GetApplicationCursorPosition());
+  for (bool left_mouse : {true, false}) {
+    if (left_mouse ? input::Input::IsLeftMouseJustDragged() : input::Input::IsRightMouseJustDragged()) {
+      auto [start, end] = input::Input::GetMouseDrag(left_mouse);
+      hit_index.TargetRectangle(*start, *end);
+    }
+  }
+
+  // Check the signals that are due given this frame's input.
+  const auto events = input::Input::GetEvents();
   input::Input::GetSignals().beginCheckSignals();
-  input::Input::GetSignals().checkSignals();
+  input::Input::GetSignals().checkSignals(events);
 
-  scene_->beginCheckSignals();
-  scene_->checkSignals();
+  scene_->checkSignals(events);
 
   scene_->updatePhysics(delta, nullptr /* No world */);
+  // Bodies have all moved, so their velocities can be integrated together.
+  physics::BodyStore::Global().Integrate(delta);
   scene_->update(delta);
 
+  if (usesSnapshots()) {
+    publishSnapshot();
+  }
+  else {
+    // Run work that other threads handed back to the game's thread, e.g. uploading generated textures.
+    utility::JobSystem::Global().RunMainThreadTasks();
+  }
+
   // Set Input object to be ready for the next update.
   input::Input::Checkpoint();
 }
 
+void Game::publishSnapshot() {
+  scene_->takeSnapshot(snapshots_.GetWriteBuffer(), next_snapshot_++);
+  snapshots_.Publish();
+
+  const auto drawn = drawn_snapshot_.load(std::memory_order_acquire);
+  std::erase_if(retired_nodes_, [drawn](const auto& retired) { return retired.first <= drawn; });
+}
+
+void Game::drawSnapshot(MTL::RenderCommandEncoder* render_command_encoder) {
+  // The render thread is the game's thread when the simulation runs independently.
+  utility::JobSystem::Global().RunMainThreadTasks();
+
+  // If nothing has been simulated yet, there is nothing to draw.
+  if (auto* snapshot = acquireSnapshot()) {
+    Scene::drawSnapshot(*snapshot, render_command_encoder);
+  }
+}
+
+const node::RenderSnapshot* Game::acquireSnapshot() {
+  auto* snapshot = snapshots_.Acquire();
+  if (snapshot) {
+    // Published before drawing, and snapshots only get newer, so this is never ahead of a snapshot still in use.
+    drawn_snapshot_.store(snapshot->GetSequence(), std::memory_order_release);
+  }
+  return snapshot;
+}
+
+void Game::beginPipelinedFrame(float delta) {
+  // Normally the last frame already waited for its tick.
+  finishSimulationJob();
+  // Picked before the next tick starts, so the frame always draws the tick before the one being simulated.
+  frame_snapshot_ = acquireSnapshot();
+  simulation_job_ = utility::JobSystem::Global().Submit([this, delta] { update(delta); });
+}
+
+void Game::drawPipelinedFrame(MTL::RenderCommandEncoder* render_command_encoder) {
+  utility::JobSystem::Global().RunMainThreadTasks();
+  if (frame_snapshot_) {
+    Scene::drawSnapshot(*frame_snapshot_, render_command_encoder);
+  }
+  // Input events are handled on this thread between frames, and the tick reads the input, so it must end with the
+  // frame.
+  finishSimulationJob();
+}
+
+void Game::finishSimulationJob() {
+  if (!simulation_job_.valid()) {
+    return;
+  }
+  // This thread does not help with other jobs while it waits: it could pick up the tick itself, or part of it, which
+  // would deadlock if that then waited on a main thread task. It does run main thread tasks, which the tick may be
+  // waiting on.
+  auto& jobs = utility::JobSystem::Global();
+  while (simulation_job_.wait_for(std::chrono::microseconds(100)) != std::future_status::ready) {
+    jobs.RunMainThreadTasks();
+  }
+  // Rethrows anything the tick threw.
+  simulation_job_.get();
+}
+
 void Game::addNode(std::unique_ptr<Node> node) {
   scene_->AddChild(std::move(node));
 }
 
 void Game::setDelegates() {
   // Set the callback
-  if (!run_simulation_independently_) {
+  if (run_simulation_independently_) {
+    // The simulation runs on its own thread, so draw whatever it last published.
+    application_->GetViewDelegate().SetRenderCallback(
+        [this](MTL::RenderCommandEncoder* render_command_encoder) { drawSnapshot(render_command_encoder); });
+  }
+  else if (pipeline_frames_) {
+    // Simulate the next tick while drawing the last one.
+    application_->GetViewDelegate().SetDrawViewCallback([this](float delta) { beginPipelinedFrame(delta); });
+    application_->GetViewDelegate().SetRenderCallback(
+        [this](MTL::RenderCommandEncoder* render_command_encoder) { drawPipelinedFrame(render_command_encoder); });
+  }
+  else {
     // If the simulation is tied to the main thread, then update the world and then draw the texture.
     application_->GetViewDelegate().SetDrawViewCallback([this](float delta) { update(delta); });
+    application_->GetViewDelegate().SetRenderCallback(
+        [this](MTL::RenderCommandEncoder* render_command_encoder) { scene_->draw(render_command_encoder); });
   }
 
-  application_->GetViewDelegate().SetRenderCallback(
-      [this](MTL::RenderCommandEncoder* render_command_encoder) { scene_->draw(render_command_encoder); });
-
   graphics::ShaderStore::makeGlobalInstance(application_->GetDevice());
 }
 
@@ -120,6 +225,7 @@ void Game::simulation(Game* game) {
   }
 
   game_clock_t::time_point last_time = game_clock_t::now();
+  game_clock_t::time_point next_time = last_time;
   while (game->is_running_) {
     game_clock_t::time_point t0           = game_clock_t::now();
     std::chrono::duration<double> elapsed = t0 - last_time;
@@ -128,9 +234,16 @@ void Game::simulation(Game* game) {
     game->update(delta);
     last_time = t0;
 
-    // TODO: Intentional sleep.
-    // Put this_thread to sleep for 100 microseconds.
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    if (0.f < game->simulation_rate_) {
+      // Keep to the rate on average, but do not try to catch up after falling far behind.
+      next_time = std::max(next_time + std::chrono::duration_cast<game_clock_t::duration>(
+                                           std::chrono::duration<float>(1.f / game->simulation_rate_)),
+                           t0);
+      std::this_thread::sleep_until(next_time);
+    }
+    else {
+      std::this_thread::yield();
+    }
   }
 }
 
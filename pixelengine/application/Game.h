@@ -4,13 +4,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <future>
 #include <thread>
 #include <list>
 
 #include "pixelengine/application/AppDelegate.h"
 #include "pixelengine/world/World.h"
+#include "pixelengine/node/RenderSnapshot.h"
 #include "pixelengine/node/Scene.h"
 #include "pixelengine/graphics/RectangularDrawable.h"
+#include "pixelengine/utility/TripleBuffer.h"
 
 namespace pixelengine::app {
 
@@ -32,6 +36,20 @@ public:
   void SetFrame(CGRect window_frame) { window_frame_ = window_frame; }
   [[nodiscard]] CGRect GetFrame() const { return window_frame_; }
 
+  //! \brief Run the simulation on its own thread, at its own rate, instead of once before every frame. After each
+  //!        update, the simulation publishes a snapshot of the scene, and every frame draws the latest one. Must be
+  //!        called before Initialize.
+  void SetRunSimulationIndependently(bool independent) { run_simulation_independently_ = independent; }
+
+  //! \brief Set how many times per second the independent simulation updates. Zero means as often as it can.
+  void SetSimulationRate(float updates_per_second) { simulation_rate_ = updates_per_second; }
+
+  //! \brief When the simulation runs once per frame, simulate the next tick on a worker while drawing the snapshot of
+  //!        the last one, so a frame takes about as long as the slower of the two, rather than both together. The
+  //!        trade-off is one frame of latency: what is drawn is always one tick behind the simulation. Must be called
+  //!        before Initialize.
+  void SetPipelineFrames(bool pipeline) { pipeline_frames_ = pipeline; }
+
 protected:
   //! \brief Load resources.
   virtual void initialize() {}
@@ -49,6 +67,28 @@ private:
   //! \brief Update step. Calls all the other update functions.
   void update(float delta);
 
+  //! \brief Take a snapshot of the scene for the renderer, and destroy removed nodes that no snapshot the renderer
+  //!        might still be drawing refers to.
+  void publishSnapshot();
+
+  //! \brief Draw the latest snapshot. Called on the render thread.
+  void drawSnapshot(MTL::RenderCommandEncoder* render_command_encoder);
+
+  //! \brief Get the latest snapshot for the renderer, and record that it is the one being drawn.
+  const node::RenderSnapshot* acquireSnapshot();
+
+  //! \brief Start a pipelined frame: pick the snapshot of the last tick to draw, and start simulating the next tick.
+  void beginPipelinedFrame(float delta);
+
+  //! \brief Draw the snapshot picked for this frame, then wait for the tick being simulated to finish.
+  void drawPipelinedFrame(MTL::RenderCommandEncoder* render_command_encoder);
+
+  //! \brief Wait for the tick being simulated on a worker, if there is one, running main thread tasks meanwhile.
+  void finishSimulationJob();
+
+  //! \brief Whether the scene is drawn from snapshots rather than from the live tree.
+  [[nodiscard]] bool usesSnapshots() const { return run_simulation_independently_ || pipeline_frames_; }
+
   static void simulation(Game* game);
 
   // ===========================================================================
@@ -69,8 +109,31 @@ private:
 
   bool run_simulation_independently_ = false;
 
-  volatile bool is_initialized_ = false;
-  bool is_running_ = false;
+  float simulation_rate_ = 0.f;
+
+  bool pipeline_frames_ = false;
+
+  //! \brief The tick being simulated during a pipelined frame.
+  std::future<void> simulation_job_;
+
+  //! \brief The snapshot drawn during a pipelined frame.
+  const node::RenderSnapshot* frame_snapshot_ {};
+
+  std::atomic<bool> is_initialized_ = false;
+  std::atomic<bool> is_running_     = false;
+
+  //! \brief Snapshots of the scene, passed from the simulation thread to the render thread.
+  utility::TripleBuffer<node::RenderSnapshot> snapshots_;
+
+  //! \brief The sequence number of the next snapshot to be taken.
+  std::size_t next_snapshot_ = 1;
+
+  //! \brief The sequence number of the snapshot the render thread is drawing. It never draws an older one again.
+  std::atomic<std::size_t> drawn_snapshot_ = 0;
+
+  //! \brief Nodes removed from the scene, kept alive until the renderer is past every snapshot that refers to them,
+  //!        with the sequence number of the first snapshot that does not.
+  std::vector<std::pair<std::size_t, std::unique_ptr<Node>>> retired_nodes_;
 
   //! \brief The game scene.
   std::unique_ptr<Scene> scene_;
@@ -9,6 +9,23 @@ namespace pixelengine::graphics {
 Drawable::Drawable(ShaderProgram* shader_program) : shader_program_(shader_program) {}
 
 void Drawable::_draw(MTL::RenderCommandEncoder* cmd_encoder) {
+  drawAt(cmd_encoder, getNetTransformation(), getTransformationVersion());
+}
+
+void Drawable::_drawSnapshot(MTL::RenderCommandEncoder* cmd_encoder,
+                             [[maybe_unused]] const node::RenderSnapshot& snapshot,
+                             const node::RenderSnapshot::NodeState& state) {
+  drawAt(cmd_encoder, state.transformation, state.transformation_version);
+}
+
+void Drawable::drawAt(MTL::RenderCommandEncoder* cmd_encoder,
+                      const math::Transformation2D& transformation,
+                      std::size_t transformation_version) {
+  if (transformation_version != drawn_transformation_version_) {
+    applyTransformation(transformation);
+    drawn_transformation_version_ = transformation_version;
+  }
+
   // Set pipeline state - tells the device (GPU) to use the shader program (includes the 
   // vertex and fragment shaders).
   shader_program_->SetPipelineState(cmd_encoder);
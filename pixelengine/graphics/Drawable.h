@@ -27,6 +27,19 @@ protected:
 
   void _draw(MTL::RenderCommandEncoder* cmd_encoder) override;
 
+  void _drawSnapshot(MTL::RenderCommandEncoder* cmd_encoder,
+                     const node::RenderSnapshot& snapshot,
+                     const node::RenderSnapshot::NodeState& state) override;
+
+  //! \brief Draw the object with the given transformation, first applying it if it changed since the last draw.
+  void drawAt(MTL::RenderCommandEncoder* cmd_encoder,
+              const math::Transformation2D& transformation,
+              std::size_t transformation_version);
+
+  //! \brief Update any vertices that depend on the node's transformation. Called while drawing, on the render
+  //!        thread, so the vertex buffers are only ever written by the thread that draws them.
+  virtual void applyTransformation([[maybe_unused]] const math::Transformation2D& transformation) {}
+
   //! \brief Draw the object.
   virtual void drawVertices(MTL::RenderCommandEncoder* cmd_encoder) = 0;
 
@@ -37,6 +50,9 @@ protected:
   std::vector<std::unique_ptr<TextureContainer>> textures_;
 
   ShaderProgram* shader_program_ {};
+
+  //! \brief The version of the transformation that the vertices were last updated with.
+  std::size_t drawn_transformation_version_ {};
 };
 
 }  // namespace pixelengine::graphics
\ No newline at end of file
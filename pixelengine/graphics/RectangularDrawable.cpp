@@ -65,7 +65,7 @@ std::unique_ptr<TextureContainer> RectangularDrawable::SwapTextures(
   return old_texture;
 }
 
-void RectangularDrawable::_onUpdatedTransform(const math::Transformation2D& transformation) {
+void RectangularDrawable::applyTransformation(const math::Transformation2D& transformation) {
   LOG_SEV(Major) << "Transformation: " << transformation;
   // Update the vertex positions based on the current transformation.
   for (auto& vert : verts_) {
@@ -34,7 +34,7 @@ public:
   [[nodiscard]] std::unique_ptr<TextureContainer> SwapTextures(std::unique_ptr<TextureContainer> new_texture);
 
 private:
-  void _onUpdatedTransform(const math::Transformation2D& transformation) override;
+  void applyTransformation(const math::Transformation2D& transformation) override;
 
   void drawVertices(MTL::RenderCommandEncoder* cmd_encoder) override;
 
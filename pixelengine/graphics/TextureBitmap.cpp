@@ -4,6 +4,7 @@
 
 #include "pixelengine/graphics/TextureBitmap.h"
 // Other files.
+#include <cstring>
 
 namespace pixelengine {
 TextureBitmap::TextureBitmap(size_t width, size_t height, MTL::Device* device)
@@ -58,6 +59,12 @@ void TextureBitmap::SetAllPixels(const Color& color) {
   is_dirty_ = true;
 }
 
+void TextureBitmap::SetPixels(std::span<const std::uint32_t> pixels) {
+  assert(pixels.size() == pixel_data.size());  // TODO: Other assert type.
+  std::memcpy(static_cast<void*>(pixel_data.data()), pixels.data(), pixels.size_bytes());
+  is_dirty_ = true;
+}
+
 Color TextureBitmap::GetPixel(std::size_t x, std::size_t y) const {
   assert(x < width_ && y < height_);  // TODO: Other assert type.
   auto index = y * width_ + x;
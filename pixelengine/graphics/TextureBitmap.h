@@ -5,6 +5,7 @@
 #pragma once
 
 #include <iostream>
+#include <span>
 
 #include <AppKit/AppKit.hpp>
 #include <Metal/Metal.hpp>
@@ -35,6 +36,9 @@ public:
 
   void SetAllPixels(const Color& color);
 
+  //! \brief Set every pixel at once, from RGBA8 pixels laid out row by row.
+  void SetPixels(std::span<const std::uint32_t> pixels);
+
   [[nodiscard]] Color GetPixel(std::size_t x, std::size_t y) const;
 
   [[nodiscard]] std::size_t GetWidth() const { return width_; }
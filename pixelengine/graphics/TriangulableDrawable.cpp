@@ -20,7 +20,7 @@ TriangulableDrawable::TriangulableDrawable(std::vector<Vec2> vertices,
   index_buffer_ = utility::AutoBuffer::New<uint16_t>(device, indices.data(), indices.size());
 }
 
-void TriangulableDrawable::_onUpdatedTransform(const math::Transformation2D& transformation) {
+void TriangulableDrawable::applyTransformation(const math::Transformation2D& transformation) {
   // Update the vertex positions based on the current transformation.
   for (auto& vert : vertices_) {
     vert = transformation.TransformPoint(vert);
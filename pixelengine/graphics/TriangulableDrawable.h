@@ -19,7 +19,7 @@ public:
   TriangulableDrawable(std::vector<Vec2> vertices, std::vector<uint16_t> indices, Color color);
 
 private:
-  void _onUpdatedTransform(const math::Transformation2D& transformation) override;
+  void applyTransformation(const math::Transformation2D& transformation) override;
 
   void drawVertices(MTL::RenderCommandEncoder* cmd_encoder) override;
 
@@ -686,7 +686,7 @@ InputSignals::InputSignals() {
     }
     return std::nullopt;
   };
-  signals_.emplace_back(&leftMouseDrag, leftMouseDragCheck);
+  signals_.emplace_back(&leftMouseDrag, leftMouseDragCheck, LeftMouseDragged);
 
   signal_check_t<Vec2, Vec2> rightMouseDragCheck = []() -> signal_emitter_t<Vec2, Vec2> {
     if (_mouse_states.right_mouse_just_dragged) {
@@ -695,14 +695,16 @@ InputSignals::InputSignals() {
     }
     return std::nullopt;
   };
-  signals_.emplace_back(&rightMouseDrag, rightMouseDragCheck);
+  signals_.emplace_back(&rightMouseDrag, rightMouseDragCheck, RightMouseDragged);
 }
 
 void InputSignals::beginCheckSignals() {}
 
-void InputSignals::checkSignals() {
+void InputSignals::checkSignals(signal_events_t events) {
   for (auto& signal : signals_) {
-    signal.CheckSignal();
+    if (signal.IsDue(events)) {
+      signal.CheckSignal();
+    }
   }
 }
 
@@ -797,5 +799,25 @@ InputSignals& Input::GetSignals() {
   return _signals;
 }
 
+signal_events_t Input::GetEvents() {
+  signal_events_t events = 0;
+  if (_mouse_states.application_cursor_position != _mouse_states.last_application_cursor_position) {
+    events |= CursorMoved;
+  }
+  if (_mouse_states.left_mouse_just_down) {
+    events |= LeftMousePressed;
+  }
+  if (_mouse_states.right_mouse_just_down) {
+    events |= RightMousePressed;
+  }
+  if (_mouse_states.left_mouse_just_dragged) {
+    events |= LeftMouseDragged;
+  }
+  if (_mouse_states.right_mouse_just_dragged) {
+    events |= RightMouseDragged;
+  }
+  return events;
+}
+
 
 }  // namespace pixelengine::input
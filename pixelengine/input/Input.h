@@ -16,6 +16,15 @@ namespace pixelengine::app {
 
 namespace pixelengine::input {
 
+//! \brief Input events that signals can be subscribed to, so they are only checked on frames where the input changed.
+enum InputEvent : signal_events_t {
+  CursorMoved       = 1 << 0,
+  LeftMousePressed  = 1 << 1,
+  RightMousePressed = 1 << 2,
+  LeftMouseDragged  = 1 << 3,
+  RightMouseDragged = 1 << 4,
+};
+
 class InputSignals {
 public:
   InputSignals();
@@ -27,7 +36,7 @@ private:
   friend class pixelengine::app::Game;
 
   void beginCheckSignals();
-  void checkSignals();
+  void checkSignals(signal_events_t events);
 
   std::list<SignalEmitter> signals_;
 };
@@ -75,6 +84,9 @@ public:
   static void Checkpoint();
 
   static InputSignals& GetSignals();
+
+  //! \brief Get the input events (see InputEvent) that happened since the last checkpoint.
+  [[nodiscard]] static signal_events_t GetEvents();
 };
 
 
@@ -0,0 +1,173 @@
+#include "pixelengine/navigation/FlowField.h"
+// Other files.
+#include <limits>
+#include <queue>
+
+namespace pixelengine::navigation {
+
+namespace {
+
+constexpr int32_t unreachable = std::numeric_limits<int32_t>::max();
+
+}  // namespace
+
+FlowField::FlowField(const MoveGraph& graph, PVec2 goal)
+    : goal_(goal)
+    , width_(graph.GetWidth())
+    , height_(graph.GetHeight())
+    , cost_(graph.GetNumPositions(), unreachable)
+    , next_(graph.GetNumPositions(), -1) {
+  std::vector<std::pair<int32_t, int32_t>> queue;
+  if (graph.IsInWorld(goal)) {
+    cost_[static_cast<std::size_t>(index(goal))] = 0;
+    queue.emplace_back(0, index(goal));
+  }
+  propagate(graph, queue);
+}
+
+void FlowField::Repair(const MoveGraph& graph, std::span<const int32_t> changed) {
+  if (changed.empty()) {
+    return;
+  }
+  // Every position whose path to the goal passes through a position whose moves changed may no longer have that
+  // path. Those positions are the changed positions, and everything whose next step leads to them.
+  std::vector<int32_t> invalid(changed.begin(), changed.end());
+  std::vector<uint8_t> is_invalid(cost_.size(), 0);
+  for (auto i : invalid) {
+    is_invalid[static_cast<std::size_t>(i)] = 1;
+  }
+  for (std::size_t k = 0; k < invalid.size(); ++k) {
+    for (auto predecessor : graph.GetPredecessors(invalid[k])) {
+      auto p = static_cast<std::size_t>(predecessor);
+      if (!is_invalid[p] && next_[p] == invalid[k]) {
+        is_invalid[p] = 1;
+        invalid.push_back(predecessor);
+      }
+    }
+  }
+  const auto goal_index = index(goal_);
+  for (auto i : invalid) {
+    if (i != goal_index) {
+      cost_[static_cast<std::size_t>(i)] = unreachable;
+      next_[static_cast<std::size_t>(i)] = -1;
+    }
+  }
+
+  // Invalid positions take the cheapest of their moves into valid positions, and then the changes spread outwards.
+  // Positions whose new moves are cheaper lower the costs of the positions behind them the same way.
+  std::vector<std::pair<int32_t, int32_t>> queue;
+  for (auto i : invalid) {
+    auto& cost = cost_[static_cast<std::size_t>(i)];
+    for (auto& move : graph.GetMoves(i)) {
+      if (move.to < 0 || is_invalid[static_cast<std::size_t>(move.to)]) {
+        continue;
+      }
+      auto through = cost_[static_cast<std::size_t>(move.to)];
+      if (through != unreachable && through + move.cost < cost) {
+        cost                               = through + move.cost;
+        next_[static_cast<std::size_t>(i)] = move.to;
+      }
+    }
+    if (cost != unreachable) {
+      queue.emplace_back(cost, i);
+    }
+  }
+  propagate(graph, queue);
+}
+
+std::optional<PVec2> FlowField::GetNextStep(PVec2 position) const {
+  if (position.x < 0 || width_ <= position.x || position.y < 0 || height_ <= position.y) {
+    return {};
+  }
+  auto next = next_[static_cast<std::size_t>(index(position))];
+  if (next < 0) {
+    return {};
+  }
+  return PVec2 {next % width_, next / width_};
+}
+
+Vec2 FlowField::GetDirection(PVec2 position) const {
+  auto next = GetNextStep(position);
+  if (!next) {
+    return {};
+  }
+  return normalize(Vec2 {static_cast<float>(next->x - position.x), static_cast<float>(next->y - position.y)});
+}
+
+std::optional<long long> FlowField::GetCost(PVec2 position) const {
+  if (position.x < 0 || width_ <= position.x || position.y < 0 || height_ <= position.y) {
+    return {};
+  }
+  auto cost = cost_[static_cast<std::size_t>(index(position))];
+  if (cost == unreachable) {
+    return {};
+  }
+  return cost;
+}
+
+void FlowField::propagate(const MoveGraph& graph, std::vector<std::pair<int32_t, int32_t>>& queue) {
+  // Dijkstra's algorithm, backwards along moves from the goal.
+  std::priority_queue open(std::greater<> {}, std::move(queue));
+  while (!open.empty()) {
+    auto [cost, position] = open.top();
+    open.pop();
+    if (cost_[static_cast<std::size_t>(position)] < cost) {
+      continue;
+    }
+    for (auto predecessor : graph.GetPredecessors(position)) {
+      for (auto& move : graph.GetMoves(predecessor)) {
+        if (move.to != position) {
+          continue;
+        }
+        auto& predecessor_cost = cost_[static_cast<std::size_t>(predecessor)];
+        if (cost + move.cost < predecessor_cost) {
+          predecessor_cost                              = cost + move.cost;
+          next_[static_cast<std::size_t>(predecessor)] = position;
+          open.emplace(predecessor_cost, predecessor);
+        }
+      }
+    }
+  }
+}
+
+int32_t FlowField::index(PVec2 position) const {
+  return static_cast<int32_t>(position.y * width_ + position.x);
+}
+
+FlowFieldService::FlowFieldService(std::size_t width,
+                                   std::size_t height,
+                                   const AgentProfile& agent,
+                                   long long tile_size)
+    : graph_(width, height, agent, tile_size) {}
+
+void FlowFieldService::Update(const world::World& world) {
+  std::erase_if(fields_, [](const auto& entry) { return entry.second.use_count() == 1; });
+
+  auto changed = graph_.Update(world);
+  is_built_    = true;
+  for (auto& [goal, field] : fields_) {
+    field->Repair(graph_, changed);
+  }
+}
+
+std::shared_ptr<const FlowField> FlowFieldService::GetField(const world::World& world, PVec2 goal) {
+  if (!is_built_) {
+    Update(world);
+  }
+  auto& agent = graph_.GetAgent();
+  Walkability walkability(world, Walkability::Reach({goal.x, goal.x, goal.y, goal.y}, agent));
+  auto landing = walkability.Land(goal, agent).value_or(goal);
+  if (!graph_.IsInWorld(landing)) {
+    return {};
+  }
+
+  auto key = graph_.Index(landing);
+  if (auto it = fields_.find(key); it != fields_.end()) {
+    return it->second;
+  }
+  auto field = std::make_shared<FlowField>(graph_, landing);
+  fields_.emplace(key, field);
+  return field;
+}
+
+}  // namespace pixelengine::navigation
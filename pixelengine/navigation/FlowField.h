@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+#include "pixelengine/navigation/MoveGraph.h"
+
+namespace pixelengine::navigation {
+
+//! \brief The cheapest way to a single goal from every position in the world, shared by every agent that is
+//!        heading for the goal.
+//!
+//! The integration field is the cost of the cheapest path from each position to the goal, and the direction field
+//! is the first move of that path. Looking up which way to go is a single array access.
+class FlowField {
+public:
+  //! \param goal The goal, which must be a standable position for anything to reach it.
+  FlowField(const MoveGraph& graph, PVec2 goal);
+
+  //! \brief Bring the field up to date after the moves of some positions changed. Only the positions whose
+  //!        cheapest path went through a changed position, or that now have a cheaper path, are recomputed.
+  void Repair(const MoveGraph& graph, std::span<const int32_t> changed);
+
+  [[nodiscard]] PVec2 GetGoal() const { return goal_; }
+
+  //! \brief Get the position that an agent at the position should move to next, if the goal can be reached from
+  //!        there. Agents that are not standing (e.g. falling) have no next step.
+  [[nodiscard]] std::optional<PVec2> GetNextStep(PVec2 position) const;
+
+  //! \brief Get the (normalized) direction an agent at the position should move in, or zero if it has no way to the
+  //!        goal.
+  [[nodiscard]] Vec2 GetDirection(PVec2 position) const;
+
+  //! \brief Get the cost of the cheapest path to the goal, if there is one.
+  [[nodiscard]] std::optional<long long> GetCost(PVec2 position) const;
+
+private:
+  //! \brief Settle the cheapest paths outwards from the queued positions, in order of cost.
+  void propagate(const MoveGraph& graph, std::vector<std::pair<int32_t, int32_t>>& queue);
+
+  [[nodiscard]] int32_t index(PVec2 position) const;
+
+  PVec2 goal_;
+  long long width_, height_;
+
+  //! \brief The integration field, the cost to reach the goal from each position.
+  std::vector<int32_t> cost_;
+
+  //! \brief The direction field, the index of the next position on the way to the goal, or -1.
+  std::vector<int32_t> next_;
+};
+
+//! \brief Hands out flow fields for agents of one size, one field per goal shared by all the agents heading there,
+//!        and keeps them up to date as the terrain changes.
+class FlowFieldService {
+public:
+  FlowFieldService(std::size_t width, std::size_t height, const AgentProfile& agent, long long tile_size = 32);
+
+  //! \brief Update the moves for any terrain that changed, and repair every field that is still in use. Fields that
+  //!        no agent holds any more are dropped.
+  void Update(const world::World& world);
+
+  //! \brief Get the flow field towards a goal, computing it if no agent is using it yet. The goal is moved to where
+  //!        an agent would land from it. Returns null if the goal is not in the world.
+  std::shared_ptr<const FlowField> GetField(const world::World& world, PVec2 goal);
+
+  [[nodiscard]] const MoveGraph& GetGraph() const { return graph_; }
+
+private:
+  MoveGraph graph_;
+
+  std::unordered_map<int32_t, std::shared_ptr<FlowField>> fields_;
+
+  bool is_built_ = false;
+};
+
+}  // namespace pixelengine::navigation
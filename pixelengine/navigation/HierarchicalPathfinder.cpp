@@ -0,0 +1,365 @@
+#include "pixelengine/navigation/HierarchicalPathfinder.h"
+// Other files.
+#include <limits>
+#include <queue>
+
+namespace pixelengine::navigation {
+
+namespace {
+
+constexpr long long unreachable = std::numeric_limits<long long>::max();
+constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+
+//! \brief A lower bound on the cost of moving between two positions, since every move costs at least the number
+//!        of squares it moves.
+long long estimateCost(PVec2 from, PVec2 to) {
+  return std::abs(to.x - from.x) + std::abs(to.y - from.y);
+}
+
+template<typename T>
+using MinQueue = std::priority_queue<std::pair<long long, T>, std::vector<std::pair<long long, T>>, std::greater<>>;
+
+}  // namespace
+
+HierarchicalPathfinder::HierarchicalPathfinder(std::size_t width,
+                                               std::size_t height,
+                                               const AgentProfile& agent,
+                                               long long cluster_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , agent_(agent)
+    , cluster_size_(cluster_size)
+    , clusters_x_((width_ + cluster_size - 1) / cluster_size)
+    , clusters_y_((height_ + cluster_size - 1) / cluster_size)
+    , clusters_(static_cast<std::size_t>(clusters_x_ * clusters_y_))
+    , watcher_(width, height, cluster_size) {}
+
+void HierarchicalPathfinder::Update(const world::World& world) {
+  auto changed = watcher_.Update(world);
+  if (!is_built_) {
+    rebuildClusters(world, changed, {});
+    is_built_ = true;
+    return;
+  }
+  if (changed.empty()) {
+    return;
+  }
+
+  std::vector<uint8_t> is_affected(clusters_.size(), 0);
+  auto mark_clusters = [&](BoundingBox region, std::vector<uint8_t>& marks) {
+    auto [x_min, x_max, y_min, y_max] = region.Clip(width_, height_);
+    for (auto cy = y_min / cluster_size_; cy <= y_max / cluster_size_; ++cy) {
+      for (auto cx = x_min / cluster_size_; cx <= x_max / cluster_size_; ++cx) {
+        marks[static_cast<std::size_t>(cy * clusters_x_ + cx)] = 1;
+      }
+    }
+  };
+  for (auto cluster : changed) {
+    mark_clusters(Walkability::Affected(getClusterBounds(cluster), agent_), is_affected);
+  }
+
+  // Rebuilding a cluster replaces its portals, so every cluster with moves into it has to reconnect to it.
+  std::vector<uint8_t> is_source(clusters_.size(), 0);
+  std::vector<std::size_t> rebuild;
+  for (std::size_t i = 0; i < clusters_.size(); ++i) {
+    if (is_affected[i]) {
+      rebuild.push_back(i);
+      auto bounds = getClusterBounds(i);
+      mark_clusters({bounds.x_min - 1,
+                     bounds.x_max + 1,
+                     bounds.y_min - agent_.climb_height,
+                     bounds.y_max + agent_.max_fall + agent_.climb_height},
+                    is_source);
+    }
+  }
+  std::vector<std::size_t> sources;
+  for (std::size_t i = 0; i < clusters_.size(); ++i) {
+    if (is_source[i] && !is_affected[i]) {
+      sources.push_back(i);
+    }
+  }
+  rebuildClusters(world, rebuild, sources);
+}
+
+std::vector<PVec2> HierarchicalPathfinder::FindPath(const world::World& world, PVec2 start, PVec2 goal) const {
+  if (!is_built_ || !isInWorld(start) || !isInWorld(goal)) {
+    return {};
+  }
+  auto land = [&](PVec2 position) {
+    Walkability walkability(world, Walkability::Reach({position.x, position.x, position.y, position.y}, agent_));
+    return walkability.Land(position, agent_);
+  };
+  auto start_position = land(start), goal_position = land(goal);
+  if (!start_position || !goal_position) {
+    return {};
+  }
+  if (*start_position == *goal_position) {
+    return {*start_position};
+  }
+
+  const auto start_cluster = getCluster(*start_position), goal_cluster = getCluster(*goal_position);
+  Walkability start_walkability(world, Walkability::Reach(getClusterBounds(start_cluster), agent_));
+  Walkability goal_walkability(world, Walkability::Reach(getClusterBounds(goal_cluster), agent_));
+
+  auto start_search = searchCluster(start_walkability, start_cluster, *start_position);
+  if (start_cluster == goal_cluster && start_search.cost[start_search.Index(*goal_position)] != unreachable) {
+    auto path = start_search.PathTo(*goal_position);
+    path.insert(path.begin(), *start_position);
+    return path;
+  }
+
+  // Search the graph of portals. The goal is a temporary node, connected to the portals of its cluster as they are
+  // reached.
+  struct Record {
+    long long cost;
+    std::size_t previous;
+    //! \brief The positions moved through to get here from the previous node.
+    std::vector<PVec2> path;
+  };
+  const auto goal_id = nodes_.size();
+  std::unordered_map<std::size_t, Record> records;
+  MinQueue<std::size_t> open;
+
+  auto position_of = [&](std::size_t id) { return id == goal_id ? *goal_position : nodes_[id].position; };
+  auto relax = [&](std::size_t id, long long cost, std::size_t previous, auto&& make_path) {
+    auto it = records.find(id);
+    if (it != records.end() && it->second.cost <= cost) {
+      return;
+    }
+    records[id] = {cost, previous, make_path()};
+    open.emplace(cost + estimateCost(position_of(id), *goal_position), id);
+  };
+
+  for (auto id : clusters_[start_cluster].portals) {
+    auto position = nodes_[id].position;
+    if (auto cost = start_search.cost[start_search.Index(position)]; cost != unreachable) {
+      relax(id, cost, no_parent, [&] { return start_search.PathTo(position); });
+    }
+  }
+
+  while (!open.empty()) {
+    auto [estimate, id] = open.top();
+    open.pop();
+    auto& record = records.at(id);
+    if (estimate != record.cost + estimateCost(position_of(id), *goal_position)) {
+      continue;  // Stale.
+    }
+    if (id == goal_id) {
+      break;
+    }
+    const auto cost = record.cost;
+    auto& node      = nodes_[id];
+    for (auto& edge : node.edges) {
+      relax(edge.to, cost + edge.cost, id, [&] {
+        return edge.path.empty() ? std::vector<PVec2> {nodes_[edge.to].position} : edge.path;
+      });
+    }
+    if (node.cluster == goal_cluster) {
+      auto search = searchCluster(goal_walkability, goal_cluster, node.position);
+      if (auto to_goal = search.cost[search.Index(*goal_position)]; to_goal != unreachable) {
+        relax(goal_id, cost + to_goal, id, [&] { return search.PathTo(*goal_position); });
+      }
+    }
+  }
+
+  if (!records.contains(goal_id)) {
+    return {};
+  }
+  std::vector<std::vector<PVec2>*> pieces;
+  for (auto id = goal_id; id != no_parent; id = records.at(id).previous) {
+    pieces.push_back(&records.at(id).path);
+  }
+  std::vector<PVec2> path {*start_position};
+  for (auto it = pieces.rbegin(); it != pieces.rend(); ++it) {
+    path.insert(path.end(), (*it)->begin(), (*it)->end());
+  }
+  return path;
+}
+
+std::size_t HierarchicalPathfinder::LocalSearch::Index(PVec2 position) const {
+  return static_cast<std::size_t>((position.y - bounds.y_min) * (bounds.x_max - bounds.x_min + 1)
+                                  + (position.x - bounds.x_min));
+}
+
+PVec2 HierarchicalPathfinder::LocalSearch::Position(std::size_t index) const {
+  auto width = bounds.x_max - bounds.x_min + 1;
+  return {bounds.x_min + static_cast<long long>(index) % width, bounds.y_min + static_cast<long long>(index) / width};
+}
+
+std::vector<PVec2> HierarchicalPathfinder::LocalSearch::PathTo(PVec2 position) const {
+  std::vector<PVec2> path;
+  auto index = Index(position);
+  if (cost[index] == unreachable) {
+    return path;
+  }
+  for (; parent[index] != no_parent; index = parent[index]) {
+    path.push_back(Position(index));
+  }
+  std::ranges::reverse(path);
+  return path;
+}
+
+HierarchicalPathfinder::LocalSearch HierarchicalPathfinder::searchCluster(const Walkability& walkability,
+                                                                          std::size_t cluster,
+                                                                          PVec2 start) const {
+  LocalSearch search {getClusterBounds(cluster), {}, {}};
+  auto size = static_cast<std::size_t>((search.bounds.x_max - search.bounds.x_min + 1)
+                                       * (search.bounds.y_max - search.bounds.y_min + 1));
+  search.cost.assign(size, unreachable);
+  search.parent.assign(size, no_parent);
+  if (!search.Contains(start)) {
+    return search;
+  }
+
+  MinQueue<std::size_t> open;
+  search.cost[search.Index(start)] = 0;
+  open.emplace(0, search.Index(start));
+  while (!open.empty()) {
+    auto [cost, index] = open.top();
+    open.pop();
+    if (search.cost[index] < cost) {
+      continue;
+    }
+    walkability.ForEachMove(search.Position(index), agent_, [&](PVec2 destination, long long move_cost) {
+      if (!search.Contains(destination)) {
+        return;
+      }
+      auto next = search.Index(destination);
+      if (cost + move_cost < search.cost[next]) {
+        search.cost[next]   = cost + move_cost;
+        search.parent[next] = index;
+        open.emplace(cost + move_cost, next);
+      }
+    });
+  }
+  return search;
+}
+
+void HierarchicalPathfinder::rebuildClusters(const world::World& world,
+                                             const std::vector<std::size_t>& clusters,
+                                             const std::vector<std::size_t>& sources) {
+  std::vector<uint8_t> is_rebuilt(clusters_.size(), 0);
+  for (auto cluster : clusters) {
+    is_rebuilt[cluster] = 1;
+    for (auto id : clusters_[cluster].portals) {
+      removeNode(id);
+    }
+    clusters_[cluster].portals.clear();
+    clusters_[cluster].needs_paths = true;
+  }
+  // Drop every edge into a removed portal before any node ids are reused.
+  for (auto& node : nodes_) {
+    if (node.is_alive) {
+      std::erase_if(node.edges, [&](const Edge& edge) { return !nodes_[edge.to].is_alive; });
+    }
+  }
+
+  // Every move from a position in one cluster into another connects two portals. Rebuilt clusters add all of their
+  // moves, source clusters only add their moves into rebuilt clusters. Portals that other clusters gain this way
+  // get their paths recomputed too.
+  auto add_moves = [&](std::size_t cluster, bool only_into_rebuilt) {
+    auto bounds = getClusterBounds(cluster);
+    Walkability walkability(world, Walkability::Reach(bounds, agent_));
+    for (auto y = bounds.y_min; y <= bounds.y_max; ++y) {
+      for (auto x = bounds.x_min; x <= bounds.x_max; ++x) {
+        PVec2 position {x, y};
+        if (!walkability.IsStandable(position, agent_)) {
+          continue;
+        }
+        walkability.ForEachMove(position, agent_, [&](PVec2 destination, long long cost) {
+          if (!isInWorld(destination) || getCluster(destination) == cluster
+              || (only_into_rebuilt && !is_rebuilt[getCluster(destination)])) {
+            return;
+          }
+          auto from = getOrCreateNode(position);
+          auto to   = getOrCreateNode(destination);
+          nodes_[from].edges.push_back({to, cost, {}});
+        });
+      }
+    }
+  };
+  for (auto cluster : clusters) {
+    add_moves(cluster, false);
+  }
+  for (auto cluster : sources) {
+    add_moves(cluster, true);
+  }
+
+  for (std::size_t cluster = 0; cluster < clusters_.size(); ++cluster) {
+    if (clusters_[cluster].needs_paths) {
+      connectPortals(world, cluster);
+    }
+  }
+}
+
+void HierarchicalPathfinder::connectPortals(const world::World& world, std::size_t cluster) {
+  auto& portals = clusters_[cluster].portals;
+  for (auto id : portals) {
+    std::erase_if(nodes_[id].edges, [&](const Edge& edge) { return nodes_[edge.to].cluster == cluster; });
+  }
+
+  Walkability walkability(world, Walkability::Reach(getClusterBounds(cluster), agent_));
+  for (auto id : portals) {
+    auto search = searchCluster(walkability, cluster, nodes_[id].position);
+    for (auto other : portals) {
+      auto position = nodes_[other].position;
+      if (other == id || search.cost[search.Index(position)] == unreachable) {
+        continue;
+      }
+      nodes_[id].edges.push_back({other, search.cost[search.Index(position)], search.PathTo(position)});
+    }
+  }
+  clusters_[cluster].needs_paths = false;
+}
+
+std::size_t HierarchicalPathfinder::getOrCreateNode(PVec2 position) {
+  if (auto it = node_ids_.find(key(position)); it != node_ids_.end()) {
+    return it->second;
+  }
+  std::size_t id;
+  if (free_nodes_.empty()) {
+    id = nodes_.size();
+    nodes_.emplace_back();
+  }
+  else {
+    id = free_nodes_.back();
+    free_nodes_.pop_back();
+  }
+  auto cluster = getCluster(position);
+  nodes_[id]   = {position, cluster, true, {}};
+  node_ids_.emplace(key(position), id);
+  clusters_[cluster].portals.push_back(id);
+  clusters_[cluster].needs_paths = true;
+  return id;
+}
+
+void HierarchicalPathfinder::removeNode(std::size_t id) {
+  auto& node = nodes_[id];
+  node_ids_.erase(key(node.position));
+  node.is_alive = false;
+  node.edges.clear();
+  free_nodes_.push_back(id);
+}
+
+BoundingBox HierarchicalPathfinder::getClusterBounds(std::size_t cluster) const {
+  auto cx = static_cast<long long>(cluster) % clusters_x_;
+  auto cy = static_cast<long long>(cluster) / clusters_x_;
+  return {cx * cluster_size_,
+          std::min((cx + 1) * cluster_size_, width_) - 1,
+          cy * cluster_size_,
+          std::min((cy + 1) * cluster_size_, height_) - 1};
+}
+
+std::size_t HierarchicalPathfinder::getCluster(PVec2 position) const {
+  return static_cast<std::size_t>((position.y / cluster_size_) * clusters_x_ + position.x / cluster_size_);
+}
+
+bool HierarchicalPathfinder::isInWorld(PVec2 position) const {
+  return 0 <= position.x && position.x < width_ && 0 <= position.y && position.y < height_;
+}
+
+uint64_t HierarchicalPathfinder::key(PVec2 position) {
+  return static_cast<uint64_t>(position.x) << 32 | static_cast<uint32_t>(position.y);
+}
+
+}  // namespace pixelengine::navigation
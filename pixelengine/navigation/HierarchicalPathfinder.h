@@ -0,0 +1,114 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "pixelengine/navigation/SolidityWatcher.h"
+
+namespace pixelengine::navigation {
+
+//! \brief Plans paths for agents of one size over a (finite) world, using hierarchical pathfinding (HPA*).
+//!
+//! The world is divided into square clusters. The positions where agents can move from one cluster to another
+//! are portals, and the portals of each cluster are connected by the cheapest paths between them that stay within
+//! the cluster. Those paths are cached, so a query searches the small graph of portals, and only searches the
+//! squares themselves within the clusters that the start and goal are in.
+//!
+//! Call Update every tick (or whenever paths are needed). Clusters are only rebuilt when the squares that block
+//! agents in or around them actually change.
+class HierarchicalPathfinder {
+public:
+  HierarchicalPathfinder(std::size_t width, std::size_t height, const AgentProfile& agent, long long cluster_size = 32);
+
+  //! \brief Rebuild any clusters whose blocking squares changed since the last update.
+  void Update(const world::World& world);
+
+  //! \brief Find a path from the start to the goal. The path is the list of standable positions (bottom left
+  //!        corners) that the agent moves through, starting with where the agent lands from the start and ending at
+  //!        where it lands from the goal. Returns an empty path if there is no path.
+  [[nodiscard]] std::vector<PVec2> FindPath(const world::World& world, PVec2 start, PVec2 goal) const;
+
+  [[nodiscard]] const AgentProfile& GetAgent() const { return agent_; }
+
+  //! \brief The number of portals in the abstract graph.
+  [[nodiscard]] std::size_t GetNumPortals() const { return node_ids_.size(); }
+
+private:
+  struct Edge {
+    std::size_t to;
+    long long cost;
+
+    //! \brief The positions moved through after leaving the start of the edge, for edges within a cluster.
+    //!        Empty for edges between clusters, which are a single move.
+    std::vector<PVec2> path;
+  };
+
+  //! \brief A portal, a standable position in a cluster that a move into or out of the cluster starts or ends at.
+  struct PortalNode {
+    PVec2 position;
+    std::size_t cluster;
+    bool is_alive = true;
+    std::vector<Edge> edges;
+  };
+
+  struct Cluster {
+    std::vector<std::size_t> portals;
+
+    //! \brief Whether the paths between the cluster's portals need to be recomputed.
+    bool needs_paths = true;
+  };
+
+  //! \brief The result of a search within a single cluster.
+  struct LocalSearch {
+    BoundingBox bounds;
+    std::vector<long long> cost;
+    std::vector<std::size_t> parent;
+
+    [[nodiscard]] bool Contains(PVec2 position) const { return bounds.Contains(position.x, position.y); }
+    [[nodiscard]] std::size_t Index(PVec2 position) const;
+    [[nodiscard]] PVec2 Position(std::size_t index) const;
+
+    //! \brief The path to a position, not including the position the search started from.
+    [[nodiscard]] std::vector<PVec2> PathTo(PVec2 position) const;
+  };
+
+  //! \brief Find the cheapest paths from a position to every position in its cluster, moving only within the
+  //!        cluster.
+  [[nodiscard]] LocalSearch searchCluster(const Walkability& walkability, std::size_t cluster, PVec2 start) const;
+
+  //! \brief Rebuild the portals of the clusters, reconnect the source clusters (which have moves into the rebuilt
+  //!        clusters) to them, and recompute the paths between portals of any cluster that gained or lost portals.
+  void rebuildClusters(const world::World& world,
+                       const std::vector<std::size_t>& clusters,
+                       const std::vector<std::size_t>& sources);
+
+  //! \brief Recompute the paths between the portals of a cluster.
+  void connectPortals(const world::World& world, std::size_t cluster);
+
+  std::size_t getOrCreateNode(PVec2 position);
+  void removeNode(std::size_t id);
+
+  [[nodiscard]] BoundingBox getClusterBounds(std::size_t cluster) const;
+  [[nodiscard]] std::size_t getCluster(PVec2 position) const;
+  [[nodiscard]] bool isInWorld(PVec2 position) const;
+
+  [[nodiscard]] static uint64_t key(PVec2 position);
+
+  long long width_, height_;
+  AgentProfile agent_;
+
+  long long cluster_size_;
+  long long clusters_x_, clusters_y_;
+
+  std::vector<Cluster> clusters_;
+
+  //! \brief Finds the clusters whose blocking squares changed.
+  SolidityWatcher watcher_;
+
+  std::vector<PortalNode> nodes_;
+  std::vector<std::size_t> free_nodes_;
+  std::unordered_map<uint64_t, std::size_t> node_ids_;
+
+  bool is_built_ = false;
+};
+
+}  // namespace pixelengine::navigation
@@ -0,0 +1,66 @@
+#include "pixelengine/navigation/MoveGraph.h"
+
+namespace pixelengine::navigation {
+
+MoveGraph::MoveGraph(std::size_t width, std::size_t height, const AgentProfile& agent, long long tile_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , agent_(agent)
+    , moves_(width * height)
+    , predecessors_(width * height)
+    , watcher_(width, height, tile_size) {}
+
+std::vector<int32_t> MoveGraph::Update(const world::World& world) {
+  std::vector<int32_t> changed;
+  for (auto tile : watcher_.Update(world)) {
+    auto affected                     = Walkability::Affected(watcher_.GetTileBounds(tile), agent_);
+    auto [x_min, x_max, y_min, y_max] = affected.Clip(width_, height_);
+    recomputeMoves(world, {x_min, x_max, y_min, y_max}, changed);
+  }
+  // Neighboring tiles' affected regions overlap, so a position can be recorded more than once.
+  std::ranges::sort(changed);
+  auto [first, last] = std::ranges::unique(changed);
+  changed.erase(first, last);
+  return changed;
+}
+
+void MoveGraph::recomputeMoves(const world::World& world, const BoundingBox& region, std::vector<int32_t>& changed) {
+  if (region.IsEmpty() || region.y_max < region.y_min) {
+    return;
+  }
+  Walkability walkability(world, Walkability::Reach(region, agent_));
+  for (auto y = region.y_min; y <= region.y_max; ++y) {
+    for (auto x = region.x_min; x <= region.x_max; ++x) {
+      PVec2 position {x, y};
+      std::array<Move, 2> moves {};
+      if (walkability.IsStandable(position, agent_)) {
+        std::size_t count = 0;
+        walkability.ForEachMove(position, agent_, [&](PVec2 destination, long long cost) {
+          if (IsInWorld(destination)) {
+            moves[count++] = {Index(destination), static_cast<int32_t>(cost)};
+          }
+        });
+      }
+
+      auto index    = Index(position);
+      auto& current = moves_[static_cast<std::size_t>(index)];
+      if (moves == current) {
+        continue;
+      }
+      for (auto& move : current) {
+        if (0 <= move.to) {
+          std::erase(predecessors_[static_cast<std::size_t>(move.to)], index);
+        }
+      }
+      current = moves;
+      for (auto& move : current) {
+        if (0 <= move.to) {
+          predecessors_[static_cast<std::size_t>(move.to)].push_back(index);
+        }
+      }
+      changed.push_back(index);
+    }
+  }
+}
+
+}  // namespace pixelengine::navigation
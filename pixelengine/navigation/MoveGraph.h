@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+
+#include "pixelengine/navigation/SolidityWatcher.h"
+
+namespace pixelengine::navigation {
+
+//! \brief Every move that an agent can make from every standable position of a (finite) world, and the reverse,
+//!        which positions can move to each position. Kept up to date as the terrain changes.
+//!
+//! An agent only ever moves left or right, so each position has at most two moves. Positions are referred to by
+//! index, y * width + x.
+class MoveGraph {
+public:
+  struct Move {
+    //! \brief The index of the position moved to, or -1 if there is no move.
+    int32_t to = -1;
+    int32_t cost = 0;
+
+    bool operator==(const Move&) const = default;
+  };
+
+  MoveGraph(std::size_t width, std::size_t height, const AgentProfile& agent, long long tile_size = 32);
+
+  //! \brief Recompute the moves of every position whose moves could have changed since the last update. Returns the
+  //!        positions whose moves actually did change.
+  std::vector<int32_t> Update(const world::World& world);
+
+  [[nodiscard]] const std::array<Move, 2>& GetMoves(int32_t index) const {
+    return moves_[static_cast<std::size_t>(index)];
+  }
+
+  //! \brief Get the positions that have a move to the position.
+  [[nodiscard]] const std::vector<int32_t>& GetPredecessors(int32_t index) const {
+    return predecessors_[static_cast<std::size_t>(index)];
+  }
+
+  [[nodiscard]] int32_t Index(PVec2 position) const { return static_cast<int32_t>(position.y * width_ + position.x); }
+
+  [[nodiscard]] PVec2 Position(int32_t index) const { return {index % width_, index / width_}; }
+
+  [[nodiscard]] bool IsInWorld(PVec2 position) const {
+    return 0 <= position.x && position.x < width_ && 0 <= position.y && position.y < height_;
+  }
+
+  [[nodiscard]] std::size_t GetNumPositions() const { return moves_.size(); }
+
+  [[nodiscard]] long long GetWidth() const { return width_; }
+  [[nodiscard]] long long GetHeight() const { return height_; }
+
+  [[nodiscard]] const AgentProfile& GetAgent() const { return agent_; }
+
+private:
+  //! \brief Recompute the moves of every position in the region, recording the positions whose moves changed.
+  void recomputeMoves(const world::World& world, const BoundingBox& region, std::vector<int32_t>& changed);
+
+  long long width_, height_;
+  AgentProfile agent_;
+
+  std::vector<std::array<Move, 2>> moves_;
+  std::vector<std::vector<int32_t>> predecessors_;
+
+  SolidityWatcher watcher_;
+};
+
+}  // namespace pixelengine::navigation
@@ -0,0 +1,64 @@
+#include "pixelengine/navigation/SolidityWatcher.h"
+// Other files.
+#include "pixelengine/world/ChangeTracker.h"
+
+namespace pixelengine::navigation {
+
+SolidityWatcher::SolidityWatcher(std::size_t width, std::size_t height, long long tile_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , tile_size_(tile_size)
+    , tiles_x_((width_ + tile_size - 1) / tile_size)
+    , hashes_(static_cast<std::size_t>(tiles_x_ * ((height_ + tile_size - 1) / tile_size)), 0) {}
+
+std::vector<std::size_t> SolidityWatcher::Update(const world::World& world) {
+  auto* tracker = world.GetChangeTracker();
+  std::vector<std::size_t> changed;
+  if (!is_first_update_ && tracker && tracker->GetVersion() == seen_version_) {
+    return changed;
+  }
+  for (std::size_t i = 0; i < hashes_.size(); ++i) {
+    if (!is_first_update_ && tracker && tracker->GetVersion(GetTileBounds(i)) <= seen_version_) {
+      continue;
+    }
+    auto hash = hashSolidity(world, i);
+    if (is_first_update_ || hash != hashes_[i]) {
+      hashes_[i] = hash;
+      changed.push_back(i);
+    }
+  }
+  seen_version_    = tracker ? tracker->GetVersion() : 0;
+  is_first_update_ = false;
+  return changed;
+}
+
+BoundingBox SolidityWatcher::GetTileBounds(std::size_t tile) const {
+  auto tx = static_cast<long long>(tile) % tiles_x_;
+  auto ty = static_cast<long long>(tile) / tiles_x_;
+  return {tx * tile_size_,
+          std::min((tx + 1) * tile_size_, width_) - 1,
+          ty * tile_size_,
+          std::min((ty + 1) * tile_size_, height_) - 1};
+}
+
+uint64_t SolidityWatcher::hashSolidity(const world::World& world, std::size_t tile) const {
+  // FNV-1a over the blocking squares of the tile.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto bounds   = GetTileBounds(tile);
+  for (auto y = bounds.y_min; y <= bounds.y_max; ++y) {
+    for (auto x = bounds.x_min; x <= bounds.x_max;) {
+      auto row = world.GetSquareRow(x, y, bounds.x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        hash = (hash ^ static_cast<uint64_t>(IsBlocking(square))) * 0x100000001b3ull;
+        ++x;
+      }
+    }
+  }
+  return hash;
+}
+
+}  // namespace pixelengine::navigation
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pixelengine/navigation/Walkability.h"
+
+namespace pixelengine::navigation {
+
+//! \brief Finds the tiles of a (finite) world in which the set of squares that block agents changed.
+//!
+//! The world's change tracker says where squares changed at all, which includes sand falling through the air and
+//! water flowing. The watcher hashes which squares are blocking in each of those tiles, so navigation only rebuilds
+//! when the terrain that agents walk on actually changed.
+class SolidityWatcher {
+public:
+  SolidityWatcher(std::size_t width, std::size_t height, long long tile_size);
+
+  //! \brief Get the tiles whose blocking squares changed since the last update. The first update returns every
+  //!        tile.
+  std::vector<std::size_t> Update(const world::World& world);
+
+  [[nodiscard]] BoundingBox GetTileBounds(std::size_t tile) const;
+
+  [[nodiscard]] std::size_t GetNumTiles() const { return hashes_.size(); }
+
+private:
+  [[nodiscard]] uint64_t hashSolidity(const world::World& world, std::size_t tile) const;
+
+  long long width_, height_;
+  long long tile_size_;
+  long long tiles_x_;
+
+  std::vector<uint64_t> hashes_;
+
+  //! \brief The newest world change that has been checked.
+  uint64_t seen_version_ = 0;
+
+  bool is_first_update_ = true;
+};
+
+}  // namespace pixelengine::navigation
@@ -0,0 +1,74 @@
+#include "pixelengine/navigation/Walkability.h"
+
+namespace pixelengine::navigation {
+
+Walkability::Walkability(const world::World& world, const BoundingBox& region)
+    : region_(region)
+    , width_(region.IsEmpty() ? 0 : region.x_max - region.x_min + 1)
+    , height_(region.IsEmpty() ? 0 : std::max(0ll, region.y_max - region.y_min + 1))
+    , prefix_(static_cast<std::size_t>((width_ + 1) * (height_ + 1)), 0) {
+  const auto stride = width_ + 1;
+  std::vector<uint8_t> blocked(static_cast<std::size_t>(width_), 1);
+  for (long long j = 0; j < height_; ++j) {
+    auto y = region_.y_min + j;
+    std::ranges::fill(blocked, 1);
+    for (auto x = region_.x_min; x <= region_.x_max;) {
+      auto row = world.GetSquareRow(x, y, region_.x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        blocked[static_cast<std::size_t>(x - region_.x_min)] = IsBlocking(square);
+        ++x;
+      }
+    }
+    uint32_t row_count = 0;
+    for (long long i = 0; i < width_; ++i) {
+      row_count += blocked[static_cast<std::size_t>(i)];
+      prefix_[static_cast<std::size_t>((j + 1) * stride + i + 1)] =
+          prefix_[static_cast<std::size_t>(j * stride + i + 1)] + row_count;
+    }
+  }
+}
+
+BoundingBox Walkability::Reach(const BoundingBox& positions, const AgentProfile& agent) {
+  return {positions.x_min - 1,
+          positions.x_max + agent.width,
+          positions.y_min - agent.max_fall - 1,
+          positions.y_max + agent.climb_height + agent.height};
+}
+
+BoundingBox Walkability::Affected(const BoundingBox& squares, const AgentProfile& agent) {
+  return {squares.x_min - agent.width,
+          squares.x_max + 1,
+          squares.y_min - agent.height - agent.climb_height,
+          squares.y_max + agent.max_fall + 1};
+}
+
+std::optional<PVec2> Walkability::Land(PVec2 position, const AgentProfile& agent) const {
+  for (long long fall = 0; fall <= static_cast<long long>(agent.max_fall); ++fall) {
+    PVec2 below {position.x, position.y - fall};
+    if (!Fits(below, agent)) {
+      return {};
+    }
+    if (IsStandable(below, agent)) {
+      return below;
+    }
+  }
+  return {};
+}
+
+long long Walkability::countBlocked(long long x_min, long long x_max, long long y_min, long long y_max) const {
+  // Anything outside the region counts as blocked.
+  if (x_min < region_.x_min || region_.x_max < x_max || y_min < region_.y_min || region_.y_max < y_max) {
+    return 1;
+  }
+  const auto stride = width_ + 1;
+  auto i0 = x_min - region_.x_min, i1 = x_max - region_.x_min + 1;
+  auto j0 = y_min - region_.y_min, j1 = y_max - region_.y_min + 1;
+  auto at = [&](long long i, long long j) { return static_cast<long long>(prefix_[static_cast<std::size_t>(j * stride + i)]); };
+  return at(i1, j1) - at(i0, j1) - at(i1, j0) + at(i0, j0);
+}
+
+}  // namespace pixelengine::navigation
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <optional>
+
+#include "pixelengine/physics/PhysicsBody.h"
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::navigation {
+
+using world::BoundingBox;
+
+//! \brief The size and movement abilities of the agents that a path is planned for.
+//!
+//! Agents move the way physics bodies do: they walk left or right, climb onto ledges no taller than their
+//! climb height, and fall when there is nothing under them. Positions are the bottom left corner of the agent.
+struct AgentProfile {
+  unsigned width = 1, height = 1;
+
+  //! \brief The tallest ledge the agent can climb onto while walking.
+  unsigned climb_height = 4;
+
+  //! \brief The furthest the agent is willing to fall. Longer drops are not used in paths.
+  unsigned max_fall = 64;
+
+  //! \brief The profile of a physics body.
+  static AgentProfile For(const physics::PhysicsBody& body, unsigned max_fall = 64) {
+    return {body.GetWidth(), body.GetHeight(), body.GetSteppingHeight(), max_fall};
+  }
+};
+
+//! \brief Whether a square of the world stops an agent, in the same way it would stop a physics body.
+inline bool IsBlocking(const world::Square& square) {
+  return square.is_occupied && square.material->IsSolidOrPowder();
+}
+
+//! \brief A snapshot of which squares in a region of the world block agents, with constant time queries for
+//!        whether an agent fits or can stand at a position.
+//!
+//! Squares outside of the world, or outside the region, are treated as blocking.
+class Walkability {
+public:
+  Walkability(const world::World& world, const BoundingBox& region);
+
+  //! \brief The region of squares that must be read to find every move from positions within `positions`.
+  static BoundingBox Reach(const BoundingBox& positions, const AgentProfile& agent);
+
+  //! \brief The region of positions whose moves depend on any of the squares within `squares`, the opposite of
+  //!        Reach.
+  static BoundingBox Affected(const BoundingBox& squares, const AgentProfile& agent);
+
+  [[nodiscard]] bool IsBlocked(long long x, long long y) const { return 0 < countBlocked(x, x, y, y); }
+
+  //! \brief Whether the agent's body is free of blocking squares at the position.
+  [[nodiscard]] bool Fits(PVec2 position, const AgentProfile& agent) const {
+    return countBlocked(position.x,
+                        position.x + agent.width - 1,
+                        position.y,
+                        position.y + agent.height - 1) == 0;
+  }
+
+  //! \brief Whether the agent fits at the position, with something under it to stand on.
+  [[nodiscard]] bool IsStandable(PVec2 position, const AgentProfile& agent) const {
+    return Fits(position, agent)
+        && 0 < countBlocked(position.x, position.x + agent.width - 1, position.y - 1, position.y - 1);
+  }
+
+  //! \brief Where an agent at the position comes to rest, if it fits there and does not fall too far.
+  [[nodiscard]] std::optional<PVec2> Land(PVec2 position, const AgentProfile& agent) const;
+
+  //! \brief Call `callback(destination, cost)` for every standable position the agent can move to in one move
+  //!        from a standable position. Moves go one square left or right, climbing a ledge or falling as needed.
+  //!        The cost of a move is the number of squares moved, horizontally and vertically.
+  template<typename Callback_t>
+  void ForEachMove(PVec2 position, const AgentProfile& agent, Callback_t&& callback) const {
+    for (long long direction : {-1ll, 1ll}) {
+      // Climb until there is room to move sideways, like PhysicsBody stepping.
+      for (long long climb = 0; climb <= static_cast<long long>(agent.climb_height); ++climb) {
+        PVec2 raised {position.x, position.y + climb};
+        if (!Fits(raised, agent)) {
+          break;  // No headroom to climb any higher.
+        }
+        PVec2 next {position.x + direction, raised.y};
+        if (!Fits(next, agent)) {
+          continue;
+        }
+        if (auto landing = Land(next, agent)) {
+          callback(*landing, 1 + climb + (next.y - landing->y));
+        }
+        break;
+      }
+    }
+  }
+
+  [[nodiscard]] const BoundingBox& GetRegion() const { return region_; }
+
+private:
+  //! \brief The number of blocking squares in the (inclusive) rectangle.
+  [[nodiscard]] long long countBlocked(long long x_min, long long x_max, long long y_min, long long y_max) const;
+
+  BoundingBox region_;
+  long long width_, height_;
+
+  //! \brief Number of blocking squares below and to the left of each corner of the region, (width + 1) by
+  //!        (height + 1).
+  std::vector<uint32_t> prefix_;
+};
+
+}  // namespace pixelengine::navigation
@@ -1,11 +1,21 @@
 #pragma once
 
+#include <limits>
+
+#include "pixelengine/node/HitIndex.h"
 #include "pixelengine/node/Node.h"
 #include "pixelengine/utility/Signal.h"
 #include "pixelengine/utility/Vec2.h"
 
 namespace pixelengine::node {
 
+//! \brief A node that detects mouse events within some area.
+//!
+//! Areas are kept in the HitIndex by their bounds, and are only checked on frames where they are targeted, i.e. when
+//! the cursor is, or just was, within their bounds, or a drag ended over them. The click and drag signals are also
+//! only checked on frames with the matching input event. Whether the cursor is inside is recomputed on every frame
+//! the area is checked, not only when the cursor moves, so an area that moves under a still cursor is entered and
+//! exited too.
 class Area : public Node {
 public:
   Area() {
@@ -13,24 +23,32 @@ public:
     addSignal(&mouseExited, this, &Area::checkMouseExited);
     addSignal(&mouseInside, this, &Area::checkMouseInside);
 
-    addSignal(&mouseLeftClicked, [this]() -> signal_emitter_t<Area*> {
-      if (input::Input::IsLeftMouseJustPressed() && cursor_pos_ && pointWithinArea(*cursor_pos_)) {
-        return std::make_tuple(this);
-      }
-      return std::nullopt;
-    });
-
-    addSignal(&mouseRightClicked, [this]() -> signal_emitter_t<Area*> {
-      if (input::Input::IsRightMouseJustPressed() && cursor_pos_ && pointWithinArea(*cursor_pos_)) {
-        return std::make_tuple(this);
-      }
-      return std::nullopt;
-    });
-
-    addSignal(&insideLeftMouseDrag, this, &Area::checkInsideLeftMouseDrag);
-    addSignal(&insideRightMouseDrag, this, &Area::checkInsideRightMouseDrag);
+    addSignal(
+        &mouseLeftClicked,
+        [this]() -> signal_emitter_t<Area*> {
+          if (input::Input::IsLeftMouseJustPressed() && mouse_inside_) {
+            return std::make_tuple(this);
+          }
+          return std::nullopt;
+        },
+        input::LeftMousePressed);
+
+    addSignal(
+        &mouseRightClicked,
+        [this]() -> signal_emitter_t<Area*> {
+          if (input::Input::IsRightMouseJustPressed() && mouse_inside_) {
+            return std::make_tuple(this);
+          }
+          return std::nullopt;
+        },
+        input::RightMousePressed);
+
+    addSignal(&insideLeftMouseDrag, this, &Area::checkInsideLeftMouseDrag, input::LeftMouseDragged);
+    addSignal(&insideRightMouseDrag, this, &Area::checkInsideRightMouseDrag, input::RightMouseDragged);
   }
 
+  ~Area() override { HitIndex::Global().Remove(this); }
+
   // ==========================================================
   // Signals
   // ==========================================================
@@ -50,11 +68,26 @@ protected:
     // TODO: This gets the "actual position" of the cursor, not relative to the area.
     cursor_pos_        = input::Input::GetApplicationCursorPosition();
     last_mouse_inside_ = mouse_inside_;
-    mouse_inside_      = cursor_pos_.has_value() && pointWithinArea(*cursor_pos_);
+    // Not skipped when the cursor stays put, since the area may have moved.
+    mouse_inside_ = cursor_pos_.has_value() && pointWithinArea(*cursor_pos_);
+  }
+
+  void _onExitingTree() override { HitIndex::Global().Remove(this); }
+
+  void _onUpdatedTransform([[maybe_unused]] const math::Transformation2D& transformation) override {
+    auto [lower, upper] = getBounds();
+    HitIndex::Global().Update(this, lower, upper);
   }
 
   virtual bool pointWithinArea(const Vec2& point) const = 0;
 
+  //! \brief Get the lower and upper corners of a box containing every point within the area. By default, the box is
+  //!        unbounded, so the area is tested whenever the cursor is in the application.
+  [[nodiscard]] virtual std::pair<Vec2, Vec2> getBounds() const {
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+    return {{-infinity, -infinity}, {infinity, infinity}};
+  }
+
   signal_emitter_t<Area*> checkMouseEntered() {
     const bool entered = mouse_inside_ && !last_mouse_inside_;
     if (entered) {
@@ -30,6 +30,15 @@ private:
     return true;
   }
 
+  std::pair<Vec2, Vec2> getBounds() const override {
+    auto bounds = std::make_pair(vertices_[0], vertices_[0]);
+    for (auto& vertex : vertices_) {
+      bounds.first  = {std::min(bounds.first.x, vertex.x), std::min(bounds.first.y, vertex.y)};
+      bounds.second = {std::max(bounds.second.x, vertex.x), std::max(bounds.second.y, vertex.y)};
+    }
+    return bounds;
+  }
+
   std::vector<Vec2> vertices_;
 };
 
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "pixelengine/utility/Contracts.h"
+#include "pixelengine/utility/Vec2.h"
+
+
+namespace pixelengine {
+class Node;
+}  // namespace pixelengine
+
+namespace pixelengine::node {
+
+//! \brief A loose grid over the bounds of nodes that can be hit by the cursor or by a drag, so the nodes that might
+//!        be hit can be found with a range query instead of by testing every node.
+//!
+//! Each node is kept in the cell that contains the center of its bounds, and queries look one cell further out in
+//! every direction, so moving a node only ever touches two cells. Nodes larger than a cell are kept in a separate
+//! list that every query checks.
+//!
+//! Every frame, the game finds the targets of the frame's input: the nodes under the cursor, the nodes that were
+//! under it in the last frame (so they can notice that it left), and the nodes inside any drag that just ended.
+class HitIndex {
+public:
+  //! \brief Create the index. Bounds are in application coordinates, which span [-1, 1].
+  explicit HitIndex(float cell_size = 0.05f) : cell_size_(cell_size) {
+    PIXEL_REQUIRE(0.f < cell_size, "cell size must be positive");
+  }
+
+  //! \brief Add a node to the index, or move it if it is already there.
+  void Update(Node* node, Vec2 lower, Vec2 upper) {
+    auto [it, is_new] = item_of_.try_emplace(node, 0);
+    if (is_new) {
+      it->second = allocate(node);
+      ++version_;
+    }
+    auto& item    = items_[it->second];
+    item.lower    = lower;
+    item.upper    = upper;
+    auto is_large = cell_size_ < upper.x - lower.x || cell_size_ < upper.y - lower.y;
+    auto cell     = is_large ? 0 : cellKey(cellOf((lower.x + upper.x) / 2), cellOf((lower.y + upper.y) / 2));
+    if (!is_new && item.is_large == is_large && item.cell == cell) {
+      return;
+    }
+    if (!is_new) {
+      unlink(it->second);
+    }
+    item.is_large = is_large;
+    item.cell     = cell;
+    link(it->second);
+  }
+
+  //! \brief Remove a node from the index. Does nothing if it is not in the index.
+  void Remove(const Node* node) {
+    auto it = item_of_.find(node);
+    if (it == item_of_.end()) {
+      return;
+    }
+    auto index = it->second;
+    item_of_.erase(it);
+    unlink(index);
+    std::erase(hovered_, index);
+    std::erase(targets_, node);
+    items_[index].node = nullptr;
+    free_items_.push_back(index);
+    ++version_;
+  }
+
+  [[nodiscard]] bool Contains(const Node* node) const { return item_of_.contains(node); }
+
+  //! \brief Find the nodes whose bounds contain a point.
+  void QueryPoint(Vec2 point, std::vector<Node*>& nodes) const {
+    query(point, point, [&](std::uint32_t index) { nodes.push_back(items_[index].node); });
+  }
+
+  //! \brief Find the nodes whose bounds overlap a rectangle, given by any two opposite corners.
+  void QueryRectangle(Vec2 corner_a, Vec2 corner_b, std::vector<Node*>& nodes) const {
+    query(lowerCorner(corner_a, corner_b), upperCorner(corner_a, corner_b), [&](std::uint32_t index) {
+      nodes.push_back(items_[index].node);
+    });
+  }
+
+  //! \brief Start finding the targets of a new frame of input, given where the cursor is, if it is in the
+  //!        application.
+  void BeginFrame(std::optional<Vec2> cursor) {
+    ++stamp_;
+    targets_.clear();
+    auto last_hovered = std::move(hovered_);
+    hovered_.clear();
+    if (cursor) {
+      query(*cursor, *cursor, [this](std::uint32_t index) { hovered_.push_back(index); });
+    }
+    for (auto index : last_hovered) {
+      target(index);
+    }
+    for (auto index : hovered_) {
+      target(index);
+    }
+  }
+
+  //! \brief Also target the nodes inside a rectangle, e.g. a drag, given by any two opposite corners.
+  void TargetRectangle(Vec2 corner_a, Vec2 corner_b) {
+    query(lowerCorner(corner_a, corner_b), upperCorner(corner_a, corner_b), [this](std::uint32_t index) {
+      target(index);
+    });
+  }
+
+  //! \brief Get the nodes targeted by this frame's input, each once.
+  [[nodiscard]] std::span<Node* const> GetTargets() const { return targets_; }
+
+  //! \brief Changes whenever a node is added to or removed from the index.
+  [[nodiscard]] std::size_t GetVersion() const { return version_; }
+
+  //! \brief Get the index that areas and points register with, created on first use.
+  static HitIndex& Global() {
+    static HitIndex index;
+    return index;
+  }
+
+private:
+  struct Item {
+    Node* node {};
+    Vec2 lower {}, upper {};
+    bool is_large {};
+    std::int64_t cell {};
+    //! \brief Where the item is in its cell's list (or the list of large items), so it can be removed without a
+    //!        search.
+    std::size_t position {};
+    //! \brief The last frame the item was targeted in.
+    std::size_t stamp {};
+  };
+
+  static Vec2 lowerCorner(Vec2 a, Vec2 b) { return {std::min(a.x, b.x), std::min(a.y, b.y)}; }
+  static Vec2 upperCorner(Vec2 a, Vec2 b) { return {std::max(a.x, b.x), std::max(a.y, b.y)}; }
+
+  [[nodiscard]] std::int32_t cellOf(float coordinate) const {
+    return static_cast<std::int32_t>(std::floor(coordinate / cell_size_));
+  }
+
+  static std::int64_t cellKey(std::int32_t x, std::int32_t y) {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32
+                                     | static_cast<std::uint32_t>(y));
+  }
+
+  std::uint32_t allocate(Node* node) {
+    std::uint32_t index;
+    if (free_items_.empty()) {
+      index = static_cast<std::uint32_t>(items_.size());
+      items_.emplace_back();
+    }
+    else {
+      index = free_items_.back();
+      free_items_.pop_back();
+    }
+    items_[index] = Item {.node = node};
+    return index;
+  }
+
+  std::vector<std::uint32_t>& listOf(const Item& item) { return item.is_large ? large_ : cells_[item.cell]; }
+
+  void link(std::uint32_t index) {
+    auto& list             = listOf(items_[index]);
+    items_[index].position = list.size();
+    list.push_back(index);
+  }
+
+  void unlink(std::uint32_t index) {
+    auto& item = items_[index];
+    auto& list = listOf(item);
+    // Swap the last item in the list into this one's place.
+    list[item.position]          = list.back();
+    items_[list.back()].position = item.position;
+    list.pop_back();
+    if (list.empty() && !item.is_large) {
+      cells_.erase(item.cell);
+    }
+  }
+
+  void target(std::uint32_t index) {
+    if (items_[index].stamp != stamp_) {
+      items_[index].stamp = stamp_;
+      targets_.push_back(items_[index].node);
+    }
+  }
+
+  //! \brief Call a function with every item whose bounds overlap the rectangle from lower to upper.
+  template<typename Func_t>
+  void query(Vec2 lower, Vec2 upper, Func_t&& func) const {
+    auto overlaps = [&](std::uint32_t index) {
+      auto& item = items_[index];
+      return item.lower.x <= upper.x && lower.x <= item.upper.x && item.lower.y <= upper.y
+          && lower.y <= item.upper.y;
+    };
+    for (auto index : large_) {
+      if (overlaps(index)) {
+        func(index);
+      }
+    }
+    // Items are no more than a cell across, so an item overlapping the rectangle has its center at most one cell
+    // outside of it.
+    for (auto x = cellOf(lower.x) - 1; x <= cellOf(upper.x) + 1; ++x) {
+      for (auto y = cellOf(lower.y) - 1; y <= cellOf(upper.y) + 1; ++y) {
+        auto it = cells_.find(cellKey(x, y));
+        if (it == cells_.end()) {
+          continue;
+        }
+        for (auto index : it->second) {
+          if (overlaps(index)) {
+            func(index);
+          }
+        }
+      }
+    }
+  }
+
+  float cell_size_;
+
+  std::vector<Item> items_;
+  std::vector<std::uint32_t> free_items_;
+  std::unordered_map<const Node*, std::uint32_t> item_of_;
+
+  //! \brief The items whose centers are in each cell.
+  std::unordered_map<std::int64_t, std::vector<std::uint32_t>> cells_;
+  //! \brief Items more than a cell across.
+  std::vector<std::uint32_t> large_;
+
+  std::size_t version_ {};
+
+  // Targets of the current frame.
+
+  std::size_t stamp_ {};
+  std::vector<std::uint32_t> hovered_;
+  std::vector<Node*> targets_;
+};
+
+}  // namespace pixelengine::node
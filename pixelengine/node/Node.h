@@ -4,12 +4,15 @@
 
 #pragma once
 
-#include <list>
+#include <mutex>
+#include <vector>
 
 #include <Lightning/Lightning.h>
 #include <Metal/Metal.hpp>
 #include <MetalKit/MetalKit.hpp>
 
+#include "pixelengine/node/RenderSnapshot.h"
+#include "pixelengine/utility/NodeRegistry.h"
 #include "pixelengine/utility/Signal.h"
 #include "pixelengine/utility/Transformation2D.h"
 
@@ -35,42 +38,59 @@ class Node {
   friend class Scene;
 
 public:
-  Node() = default;
-  Node(std::string_view name) : name_(name) { LOG_SEV(Trace) << "Node created: " << *this; }
-  virtual ~Node() = default;
+  Node() : handle_(NodeRegistry::Global().Register(this, name_)) {}
+  Node(std::string_view name) : name_(name), handle_(NodeRegistry::Global().Register(this, name_)) {
+    LOG_SEV(Trace) << "Node created: " << *this;
+  }
+  virtual ~Node() { NodeRegistry::Global().Unregister(handle_); }
 
-  //! \brief Set an identifying name for the node. Purely for debuging purposes.
-  void SetName(std::string name) { name_ = std::move(name); }
+  //! \brief Set an identifying name for the node. The node can be found by its name, or by its path of names from
+  //!        the root, through the NodeRegistry.
+  void SetName(std::string name) {
+    name_ = std::move(name);
+    NodeRegistry::Global().Rename(handle_, name_);
+  }
 
   //! \brief Get the name of the node.
   [[nodiscard]] const std::string& GetName() const { return name_; }
 
-  //! \brief Add a child of the node. Adds as the child with the least precedence.
+  //! \brief Get a handle to the node, which can be held safely after the node is removed and destroyed.
+  [[nodiscard]] NodeHandle GetHandle() const { return handle_; }
+
+  //! \brief Add a child of the node. Adds as the child with the least precedence. The child is queued, and only
+  //!        added at the start of the next frame, so this is safe to call from parallel subtrees.
   void AddChild(std::unique_ptr<Node> child) {
     if (!child) {
       LOG_SEV(Debug) << "Warning: Trying to add null child to Node [" << *this << "].";
       return;
     }
+    std::lock_guard lock(structure_mutex_);
     if (child->parent_ == this) {
       return;  // Already a child of this node.
     }
     // If the child currently has a parent, remove it from the parent's children.
     if (child->parent_) {
-      child->parent_->QueueRemoveChild(child.get());
+      child->parent_->queueRemoveChild(child.get());
     }
     queued_children_.push_back(std::move(child));
+    markQueuedAdditions();
     LOG_SEV(Trace) << "Added child " << *queued_children_.back().get() << " to node " << *this << ".";
   }
 
-  //! \brief Queue a node to be removed as a child of this node. If the node is not a child, does nothing.
+  //! \brief Queue a node to be removed as a child of this node. If the node is not a child, does nothing. Like
+  //!        AddChild, this is safe to call from parallel subtrees.
   void QueueRemoveChild(Node* child) {
-    auto it = std::ranges::find_if(children_, [child](const auto& c) { return c.get() == child; });
-    if (it != children_.end()) {
-      (*it)->queued_for_deletion_ = true;
-      LOG_SEV(Trace) << "Queued child " << *child << " for deletion from node " << *this << ".";
-    }
+    std::lock_guard lock(structure_mutex_);
+    queueRemoveChild(child);
   }
 
+  //! \brief Declare whether the node's subtree is parallel-safe, i.e. during the physics and update phases it only
+  //!        touches its own state, and makes structural changes through AddChild and QueueRemoveChild. Sibling
+  //!        parallel-safe subtrees then run at the same time as each other, after the rest of the tree.
+  void SetParallelSafe(bool is_parallel_safe) { is_parallel_safe_ = is_parallel_safe; }
+
+  [[nodiscard]] bool IsParallelSafe() const { return is_parallel_safe_; }
+
   [[nodiscard]] std::size_t GetNumChildren() const { return children_.size(); }
 
   Node& AsNode() { return *this; }
@@ -116,39 +136,115 @@ private:
     }
   }
 
+  void queueRemoveChild(Node* child) {
+    if (child->index_in_parent_ < children_.size() && children_[child->index_in_parent_].get() == child) {
+      child->queued_for_deletion_ = true;
+      markQueuedRemovals();
+      LOG_SEV(Trace) << "Queued child " << *child << " for deletion from node " << *this << ".";
+    }
+  }
+
   void addedBy(Node* parent) {
     parent_ = parent;
+    NodeRegistry::Global().SetParent(handle_, parent->handle_);
     _onAddedBy(parent);
   }
 
-  void removeQueuedChildren() {
+  void leavingFrom(Node* parent) {
+    // The node is the root of its own tree from now on, so it is no longer found by a path through its old parent.
+    NodeRegistry::Global().SetParent(handle_, {});
+    _onLeavingFrom(parent);
+    exitingTree();
+  }
+
+  void exitingTree() {
+    _onExitingTree();
     for (auto& child : children_) {
-      child->removeQueuedChildren();
+      child->exitingTree();
     }
+  }
 
-    children_.remove_if([this](const auto& child) {
-      if (child->queued_for_deletion_) {
-        _childLeaving(child.get());
-        child->_onLeavingFrom(this);
-        LOG_SEV(Trace) << "Removed child " << *child << " from node " << *this << ".";
-      }
-      return child->queued_for_deletion_;
-    });
+  //! \brief Remove all nodes queued for removal, only descending into subtrees where some are. Returns whether any
+  //!        node was removed.
+  //!
+  //! If `retired` is given, removed nodes are moved into it instead of being destroyed, e.g. because a snapshot that
+  //! is still being drawn refers to them.
+  bool removeQueuedChildren(std::vector<std::unique_ptr<Node>>* retired = nullptr) {
+    if (!has_queued_removals_) {
+      return false;
+    }
+    // Cleared first, so removals queued while this runs are picked up next time.
+    has_queued_removals_ = false;
+    bool any_removed     = false;
+    for (auto& child : children_) {
+      any_removed |= child->removeQueuedChildren(retired);
+    }
+    return removeOwnQueuedChildren(retired) || any_removed;
   }
 
-  void addQueuedChildren() {
-    auto former_size = children_.size();
-    children_.splice(children_.end(), std::move(queued_children_));
-    auto count = 0;
-    for (auto it = children_.rbegin(); former_size < children_.size() - count; ++it, ++count) {
-      // Callback to the node that it was added to the parent
-      (*it)->addedBy(this);
-      _childEntering(it->get());
+  //! \brief Remove the children of this node (but not of its children) that are queued for removal. Returns whether
+  //!        any were removed.
+  bool removeOwnQueuedChildren(std::vector<std::unique_ptr<Node>>* retired = nullptr) {
+    auto first = std::ranges::find_if(children_, [](const auto& child) { return child->queued_for_deletion_; });
+    if (first == children_.end()) {
+      return false;
+    }
+    const auto first_index = static_cast<std::size_t>(first - children_.begin());
+    for (auto& child : std::ranges::subrange(first, children_.end())) {
+      if (!child->queued_for_deletion_) {
+        continue;
+      }
+      _childLeaving(child.get());
+      child->leavingFrom(this);
+      LOG_SEV(Trace) << "Removed child " << *child << " from node " << *this << ".";
+      if (retired) {
+        retired->push_back(std::move(child));
+      }
+      else {
+        child.reset();
+      }
+    }
+    std::erase(children_, nullptr);
+    // Only the children after the first removed one moved.
+    for (auto i = first_index; i < children_.size(); ++i) {
+      children_[i]->index_in_parent_ = i;
     }
+    return true;
+  }
 
+  //! \brief Add all nodes queued for addition, only descending into subtrees where some are. Returns whether any
+  //!        node was added.
+  bool addQueuedChildren() {
+    if (!has_queued_additions_) {
+      return false;
+    }
+    has_queued_additions_ = false;
+    bool any_added        = 0 < addOwnQueuedChildren();
     for (auto& child : children_) {
-      child->addQueuedChildren();
+      any_added |= child->addQueuedChildren();
+    }
+    return any_added;
+  }
+
+  //! \brief Add the children queued to this node (but not to its children). Returns how many were added, which are
+  //!        the last children of the node.
+  std::size_t addOwnQueuedChildren() {
+    if (queued_children_.empty()) {
+      return 0;
+    }
+    auto added = std::move(queued_children_);
+    queued_children_.clear();
+    const auto former_size = children_.size();
+    children_.insert(children_.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+    for (auto i = former_size; i < children_.size(); ++i) {
+      children_[i]->index_in_parent_ = i;
+    }
+    for (auto i = children_.size(); former_size < i; --i) {
+      // Callback to the node that it was added to the parent
+      children_[i - 1]->addedBy(this);
+      _childEntering(children_[i - 1].get());
     }
+    return children_.size() - former_size;
   }
 
   void interactWithWorld(world::World* world) {
@@ -195,6 +291,20 @@ private:
     }
   }
 
+  //! \brief Mark this node, and every node above it, as having nodes queued for addition somewhere below.
+  void markQueuedAdditions() {
+    for (auto node = this; node && !node->has_queued_additions_; node = node->parent_) {
+      node->has_queued_additions_ = true;
+    }
+  }
+
+  //! \brief Mark this node, and every node above it, as having nodes queued for removal somewhere below.
+  void markQueuedRemovals() {
+    for (auto node = this; node && !node->has_queued_removals_; node = node->parent_) {
+      node->has_queued_removals_ = true;
+    }
+  }
+
   //! \brief Transitively release all children, depth first.
   void releaseChildren() {
     for (auto& child : children_) {
@@ -204,20 +314,27 @@ private:
   }
 
 protected:
-  void addSignal(SignalEmitter signal) { signals_.emplace_back(std::move(signal)); }
+  //! \brief Add a signal to be checked. If it is given events, it is only checked on frames where one of them
+  //!        happened, otherwise, it is checked every frame.
+  void addSignal(SignalEmitter signal) {
+    signals_.emplace_back(std::move(signal));
+    // Scenes keep track of which nodes subscribe to which events.
+    ++signals_version_;
+  }
 
   template<typename... Args_t, typename Func_t>
-  void addSignal(Signal<Args_t...>* signal, Func_t check) {
-    signals_.push_back(
-        SignalEmitter(signal, std::function<std::optional<std::tuple<Args_t...>>()>(std::move(check))));
+  void addSignal(Signal<Args_t...>* signal, Func_t check, signal_events_t events = 0) {
+    addSignal(SignalEmitter(
+        signal, std::function<std::optional<std::tuple<Args_t...>>()>(std::move(check)), events));
   }
 
   template<typename Obj_t, typename... Args_t>
   void addSignal(Signal<Args_t...>* signal,
                  Obj_t* obj,
-                 std::optional<std::tuple<Args_t...>> (Obj_t::*check)()) {
+                 std::optional<std::tuple<Args_t...>> (Obj_t::*check)(),
+                 signal_events_t events = 0) {
     using func_t = std::function<std::optional<std::tuple<Args_t...>>()>;
-    signals_.push_back(SignalEmitter(signal, static_cast<func_t>(std::bind_front(check, obj))));
+    addSignal(SignalEmitter(signal, static_cast<func_t>(std::bind_front(check, obj)), events));
   }
 
 protected:
@@ -235,6 +352,18 @@ protected:
 
   virtual void _draw([[maybe_unused]] MTL::RenderCommandEncoder* render_command_encoder) {}
 
+  //! \brief Record what drawing the node needs, beyond its transformation, e.g. a plane of its colors. Called on the
+  //!        simulation thread after each update, when the game simulates independently of rendering.
+  virtual void _snapshot([[maybe_unused]] node::RenderSnapshot& snapshot) const {}
+
+  //! \brief Draw the node as it was in a snapshot. Called on the render thread while the simulation keeps running, so
+  //!        this must only read the snapshot, and state that only drawing touches. By default, just calls _draw.
+  virtual void _drawSnapshot(MTL::RenderCommandEncoder* render_command_encoder,
+                             [[maybe_unused]] const node::RenderSnapshot& snapshot,
+                             [[maybe_unused]] const node::RenderSnapshot::NodeState& state) {
+    _draw(render_command_encoder);
+  }
+
   //! \brief Called right after the node is added to the Tree, and before the parent has _childEntering
   //!        called.
   virtual void _onAddedBy([[maybe_unused]] Node* parent) {}
@@ -248,6 +377,10 @@ protected:
   //! \brief Called right before the node is removed from the Tree, and after the parent has _childLeaving
   virtual void _onLeavingFrom([[maybe_unused]] Node* parent) {}
 
+  //! \brief Called on every node of a subtree that is removed from the Tree, after its root has _onLeavingFrom. The
+  //!        nodes may be kept alive for a while after this, e.g. while a snapshot still refers to them.
+  virtual void _onExitingTree() {}
+
   //! \brief Update any points that depend on the node's transformation.
   virtual void _onUpdatedTransform([[maybe_unused]] const math::Transformation2D& transformation) {}
 
@@ -261,19 +394,31 @@ protected:
   // Transformation
 
   void updateTransformation(bool upstream_updated, const math::Transformation2D& parent_transformation) {
+    const bool needs_update = updateOwnTransformation(upstream_updated, parent_transformation);
+    for (auto& child : children_) {
+      child->updateTransformation(needs_update, net_transformation_);
+    }
+  }
+
+  //! \brief Update the net transformation of this node (but not of its children). Returns whether it was updated.
+  bool updateOwnTransformation(bool upstream_updated, const math::Transformation2D& parent_transformation) {
     const bool needs_update = transformation_changed_ || upstream_updated;
     transformation_changed_ = false;
 
     if (needs_update) {
       net_transformation_ = parent_transformation * transformation_;
+      ++transformation_version_;
       _onUpdatedTransform(net_transformation_);
       LOG_SEV(Info) << GetName() << ": Updated transformation: " << transformation_ << " (parent = " << parent_transformation << ") (net = " << net_transformation_ << ")";
     }
-    for (auto& child : children_) {
-      child->updateTransformation(needs_update, net_transformation_);
-    }
+    return needs_update;
   }
 
+  [[nodiscard]] const math::Transformation2D& getNetTransformation() const { return net_transformation_; }
+
+  //! \brief Changes whenever the net transformation is updated.
+  [[nodiscard]] std::size_t getTransformationVersion() const { return transformation_version_; }
+
   // ===========================================================================
   //  Protected member variables.
   // ===========================================================================
@@ -281,18 +426,41 @@ protected:
 private:
   std::string name_ = "<unnamed>";
 
+  //! \brief The node's entry in the registry. Must come after the name, which it is registered with.
+  NodeHandle handle_;
+
   Node* parent_ {};
 
   //! \brief Whether the node is queued for deletion.
   bool queued_for_deletion_ {false};
 
+  //! \brief The position of the node in its parent's children, so it can be found without a search.
+  std::size_t index_in_parent_ {};
+
+  //! \brief Whether this node or any node below it has children queued for addition. A node that is not yet in the
+  //!        tree keeps the flag until it is added, so the pass descends into it.
+  bool has_queued_additions_ {false};
+
+  //! \brief Whether any child of this node, or of a node below it, is queued for removal.
+  bool has_queued_removals_ {false};
+
+  //! \brief Guards the queues of children to add and remove, and the flags marking them up the tree, since parallel
+  //!        subtrees may queue changes at the same time.
+  inline static std::mutex structure_mutex_;
+
+  //! \brief Whether the node's subtree can run at the same time as other parallel-safe subtrees.
+  bool is_parallel_safe_ {false};
+
   //! \brief Children to be added.
-  std::list<std::unique_ptr<Node>> queued_children_;
+  std::vector<std::unique_ptr<Node>> queued_children_;
 
   //! \brief Current children.
-  std::list<std::unique_ptr<Node>> children_;
+  std::vector<std::unique_ptr<Node>> children_;
+
+  std::vector<SignalEmitter> signals_;
 
-  std::list<SignalEmitter> signals_;
+  //! \brief Changes whenever any node adds a signal.
+  inline static std::size_t signals_version_ {};
 
   //! \brief Transformation (displacement and transformation matrix), relative to parent.
   math::Transformation2D transformation_ = math::Transformation2D::Identity();
@@ -300,6 +468,8 @@ private:
   //! \brief Net transformation relative to root node.
   math::Transformation2D net_transformation_ = math::Transformation2D::Identity();
 
+  std::size_t transformation_version_ {};
+
   //! \brief Whether `transformation_` has changed since the last updateTransformation.
   //!        Initialized to true to propagate transformation changes.
   bool transformation_changed_ = true;
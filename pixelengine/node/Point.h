@@ -1,5 +1,6 @@
 #pragma once
 
+#include "pixelengine/node/HitIndex.h"
 #include "pixelengine/node/Node.h"
 #include "pixelengine/utility/Signal.h"
 #include "pixelengine/utility/Vec2.h"
@@ -7,32 +8,42 @@
 namespace pixelengine::node {
 
 //! \brief A point node that can be used to detect mouse events.
+//!
+//! Points are kept in the HitIndex, so their drag signals are only checked when a drag ends around them.
 class Point : public Node {
 public:
   Point(Vec2 position) {
     SetPosition(position);
 
-    addSignal(&insideLeftMouseDrag, [this]() -> signal_emitter_t<Point*> {
-      if (input::Input::IsLeftMouseJustDragged()) {
-        auto [start, end] = input::Input::GetMouseDrag(true /* true => left */);
-        if (WithinRectangle(*start, *end, GetNetPosition())) {
-          return std::make_tuple(this);
-        }
-      }
-      return {};
-    });
-
-    addSignal(&insideRightMouseDrag, [this]() -> signal_emitter_t<Point*> {
-      if (input::Input::IsRightMouseJustDragged()) {
-        auto [start, end] = input::Input::GetMouseDrag(false /* false => right */);
-        if (WithinRectangle(*start, *end, GetNetPosition())) {
-          return std::make_tuple(this);
-        }
-      }
-      return {};
-    });
+    addSignal(
+        &insideLeftMouseDrag,
+        [this]() -> signal_emitter_t<Point*> {
+          if (input::Input::IsLeftMouseJustDragged()) {
+            auto [start, end] = input::Input::GetMouseDrag(true /* true => left */);
+            if (WithinRectangle(*start, *end, GetNetPosition())) {
+              return std::make_tuple(this);
+            }
+          }
+          return {};
+        },
+        input::LeftMouseDragged);
+
+    addSignal(
+        &insideRightMouseDrag,
+        [this]() -> signal_emitter_t<Point*> {
+          if (input::Input::IsRightMouseJustDragged()) {
+            auto [start, end] = input::Input::GetMouseDrag(false /* false => right */);
+            if (WithinRectangle(*start, *end, GetNetPosition())) {
+              return std::make_tuple(this);
+            }
+          }
+          return {};
+        },
+        input::RightMouseDragged);
   }
 
+  ~Point() override { HitIndex::Global().Remove(this); }
+
   Signal<Point*> insideLeftMouseDrag;
   Signal<Point*> insideRightMouseDrag;
 
@@ -42,6 +53,12 @@ protected:
     cursor_pos_ = input::Input::GetApplicationCursorPosition();
   }
 
+  void _onExitingTree() override { HitIndex::Global().Remove(this); }
+
+  void _onUpdatedTransform([[maybe_unused]] const math::Transformation2D& transformation) override {
+    HitIndex::Global().Update(this, GetNetPosition(), GetNetPosition());
+  }
+
   std::optional<Vec2> cursor_pos_ {};
 };
 
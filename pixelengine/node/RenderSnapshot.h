@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "pixelengine/utility/Contracts.h"
+#include "pixelengine/utility/Transformation2D.h"
+
+
+namespace pixelengine {
+class Node;
+}  // namespace pixelengine
+
+namespace pixelengine::node {
+
+//! \brief Everything the renderer needs from one simulation step, so the scene can be drawn while the next step is
+//!        being simulated. A snapshot is filled by the simulation thread and then only read.
+//!
+//! For every node, in drawing order, the snapshot has the node's transformation. Nodes that draw from their own
+//! state, like a world drawing its squares, add a plane of colors for themselves while the snapshot is taken. Since
+//! taking the snapshot holds up the simulation, planes should be plain copies of the node's state, with any work to
+//! turn them into pixels left to the render thread.
+class RenderSnapshot {
+public:
+  //! \brief A rectangle of RGBA8 pixels, row by row, and optionally a light level for each pixel. How the pixels are
+  //!        laid out, and how they are turned into what is drawn, is up to the node that added the plane.
+  struct ColorPlane {
+    std::size_t width {}, height {};
+    std::vector<std::uint32_t> pixels;
+    //! \brief Empty, unless the plane was made with levels.
+    std::vector<std::uint8_t> levels;
+
+    //! \brief Set the size of the plane, keeping its storage.
+    void Resize(std::size_t new_width, std::size_t new_height, bool with_levels = false) {
+      width  = new_width;
+      height = new_height;
+      pixels.resize(width * height);
+      levels.resize(with_levels ? width * height : 0);
+    }
+  };
+
+  struct NodeState {
+    Node* node {};
+    math::Transformation2D transformation;
+    //! \brief Changes whenever the node's transformation does, so drawing can skip unchanged transformations.
+    std::size_t transformation_version {};
+    std::optional<std::size_t> plane {};
+  };
+
+  //! \brief Empty the snapshot, keeping its storage for the next one.
+  void Clear(std::size_t sequence) {
+    sequence_ = sequence;
+    nodes_.clear();
+    num_planes_ = 0;
+  }
+
+  void AddNode(Node* node, const math::Transformation2D& transformation, std::size_t transformation_version) {
+    nodes_.push_back({node, transformation, transformation_version});
+  }
+
+  //! \brief Add a plane of colors, and of light levels if asked for, for the node that was added last. The pixels
+  //!        and levels are left as they were in the last snapshot that used the storage, and should all be set.
+  ColorPlane& AddPlane(std::size_t width, std::size_t height, bool with_levels = false) {
+    PIXEL_ASSERT(!nodes_.empty(), "a plane must belong to a node");
+    if (planes_.size() == num_planes_) {
+      planes_.emplace_back();
+    }
+    auto& plane = planes_[num_planes_];
+    plane.Resize(width, height, with_levels);
+    nodes_.back().plane = num_planes_++;
+    return plane;
+  }
+
+  [[nodiscard]] const ColorPlane* GetPlane(const NodeState& state) const {
+    return state.plane ? &planes_[*state.plane] : nullptr;
+  }
+
+  [[nodiscard]] std::span<const NodeState> GetNodes() const { return nodes_; }
+
+  //! \brief Snapshots are numbered in the order they are taken.
+  [[nodiscard]] std::size_t GetSequence() const { return sequence_; }
+
+private:
+  std::size_t sequence_ {};
+  std::vector<NodeState> nodes_;
+  std::vector<ColorPlane> planes_;
+  std::size_t num_planes_ {};
+};
+
+}  // namespace pixelengine::node
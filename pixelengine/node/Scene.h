@@ -1,8 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
 #include <ranges>
 
+#include "pixelengine/node/HitIndex.h"
 #include "pixelengine/node/Node.h"
+#include "pixelengine/node/RenderSnapshot.h"
+#include "pixelengine/utility/JobSystem.h"
 
 
 namespace pixelengine {
@@ -12,12 +19,289 @@ class Game;
 }  // namespace app
 
 //! \brief A scene in the game.
+//!
+//! The scene runs each phase of the update over the whole tree of nodes. Instead of walking the tree recursively
+//! in every phase, it keeps the nodes in a flat list, in the same (pre-)order as the walk, which is only rebuilt
+//! when nodes are added or removed.
+//!
+//! Signals are not checked by walking the tree. The scene keeps lists of the nodes with signals that are checked
+//! every frame, and of the nodes subscribed to each event, so the cost of checking signals depends on the events that
+//! happened rather than on how many nodes there are. Nodes in the HitIndex are left out of those lists, and are only
+//! checked when this frame's input targets them.
+//!
+//! In the physics and update phases, subtrees whose roots are parallel-safe are skipped during the walk, and then
+//! run at the same time as one another on the job system. The phase ends once all of them are done.
+//!
+//! When the game simulates independently of rendering, the scene is drawn from snapshots taken after each update,
+//! instead of from the live tree.
 class Scene : public Node {
   friend class app::Game;
 
 public:
 
 private:
+  //! \brief A node in the flattened tree, and how far below the scene it is.
+  struct Entry {
+    Node* node;
+    std::size_t depth;
+    //! \brief One past the last node of the node's subtree in the flattened tree.
+    std::size_t end;
+  };
+
+  //! \brief A parallel-safe subtree to run after the rest of the tree, and the world its root gets.
+  struct ParallelTask {
+    std::size_t begin;
+    world::World* world;
+  };
+
+  //! \brief A node with signals, and where it is in the flattened tree.
+  struct Subscriber {
+    std::size_t position;
+    Node* node;
+
+    friend auto operator<=>(const Subscriber&, const Subscriber&) = default;
+  };
+
+  // ===========================================================================
+  //  The phases of the update, run over the whole tree.
+  // ===========================================================================
+
+  // Adding and removing only descend into the subtrees that changed, so there is no need for the flat list.
+
+  void removeQueuedChildren(std::vector<std::unique_ptr<Node>>* retired = nullptr) {
+    is_order_stale_ |= Node::removeQueuedChildren(retired);
+  }
+
+  void addQueuedChildren() { is_order_stale_ |= Node::addQueuedChildren(); }
+
+  void updateTransformation(bool upstream_updated, const math::Transformation2D& parent_transformation) {
+    for ([[maybe_unused]] auto& [node, depth, end] : getOrder()) {
+      auto needs_update = depth == 0
+                            ? node->updateOwnTransformation(upstream_updated, parent_transformation)
+                            : node->updateOwnTransformation(updated_at_depth_[depth - 1],
+                                                            node->parent_->net_transformation_);
+      updated_at_depth_[depth] = needs_update;
+    }
+  }
+
+  //! \brief Check the signals that are due given the events that happened this frame, and that something listens to.
+  void checkSignals(signal_events_t events) {
+    updateSubscribers();
+
+    due_.assign(polled_.begin(), polled_.end());
+    for (auto remaining = events; remaining != 0; remaining &= remaining - 1) {
+      auto& subscribers = subscribers_[std::countr_zero(remaining)];
+      due_.insert(due_.end(), subscribers.begin(), subscribers.end());
+    }
+    // A node can be subscribed to several events. Visit each node once, in the order of the tree.
+    std::ranges::sort(due_);
+    due_.erase(std::ranges::unique(due_).begin(), due_.end());
+    // Targets of the input are never in the lists, so they are already unique. They come after the other nodes.
+    for (auto* node : node::HitIndex::Global().GetTargets()) {
+      due_.push_back({order_.size(), node});
+    }
+    std::erase_if(due_, [events](const Subscriber& subscriber) {
+      return std::ranges::none_of(subscriber.node->signals_, [events](const SignalEmitter& signal) {
+        return signal.IsDue(events) && signal.HasListeners();
+      });
+    });
+
+    for (auto& subscriber : due_) {
+      subscriber.node->_beginCheckSignals();
+    }
+    for (auto& subscriber : due_) {
+      for (auto& signal : subscriber.node->signals_) {
+        if (signal.IsDue(events)) {
+          signal.CheckSignal();
+        }
+      }
+    }
+  }
+
+  void updatePhysics(float dt, world::World* world) {
+    auto& order = getOrder();
+    parallel_tasks_.clear();
+    world_at_depth_[0] = world;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      if (isParallelRoot(i)) {
+        parallel_tasks_.push_back({i, world_at_depth_[order[i].depth]});
+        i = order[i].end - 1;
+        continue;
+      }
+      updateNodePhysics(order[i], dt, world_at_depth_);
+    }
+
+    utility::JobSystem::Global().ParallelFor(parallel_tasks_.size(), [&](std::size_t index) {
+      auto [begin, task_world] = parallel_tasks_[index];
+      // Each task needs its own per-depth worlds, from the depth of its root down. This is not thread_local, since a
+      // node that waits on the job system may run another task on the same thread before it finishes.
+      const auto base_depth = order[begin].depth;
+      std::vector<world::World*> task_world_at_depth(world_at_depth_.size() - base_depth, nullptr);
+      task_world_at_depth[0] = task_world;
+      for (auto i = begin; i < order[begin].end; ++i) {
+        updateNodePhysics(order[i], dt, task_world_at_depth, base_depth);
+      }
+    });
+  }
+
+  void update(float dt) {
+    auto& order = getOrder();
+    parallel_tasks_.clear();
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      if (isParallelRoot(i)) {
+        parallel_tasks_.push_back({i, nullptr});
+        i = order[i].end - 1;
+        continue;
+      }
+      order[i].node->_update(dt);
+    }
+
+    utility::JobSystem::Global().ParallelFor(parallel_tasks_.size(), [&](std::size_t index) {
+      const auto begin = parallel_tasks_[index].begin;
+      for (auto i = begin; i < order[begin].end; ++i) {
+        order[i].node->_update(dt);
+      }
+    });
+  }
+
+  //! \brief Whether the node at a position in the order is the root of a subtree to run in parallel. Only the
+  //!        outermost parallel-safe nodes are reached, since their subtrees are skipped.
+  [[nodiscard]] bool isParallelRoot(std::size_t position) const {
+    return position != 0 && order_[position].node->is_parallel_safe_;
+  }
+
+  //! \brief Do the physics update of one node, reading its world from, and writing its children's world to, the
+  //!        per-depth worlds, which start at some base depth.
+  static void updateNodePhysics(const Entry& entry,
+                                float dt,
+                                std::vector<world::World*>& world_at_depth,
+                                std::size_t base_depth = 0) {
+    auto depth       = entry.depth - base_depth;
+    auto* node_world = world_at_depth[depth];
+    entry.node->_interactWithWorld(node_world);
+    entry.node->_updatePhysics(dt, node_world);
+    // Potentially pass a different world to lower levels.
+    world_at_depth[depth + 1] = entry.node->_setWorld(node_world);
+  }
+
+  void draw(MTL::RenderCommandEncoder* render_command_encoder) {
+    for (auto& entry : getOrder()) {
+      entry.node->_draw(render_command_encoder);
+    }
+  }
+
+  //! \brief Record the transformation of every node, and whatever else they need to be drawn, in drawing order.
+  void takeSnapshot(node::RenderSnapshot& snapshot, std::size_t sequence) {
+    snapshot.Clear(sequence);
+    for (auto& entry : getOrder()) {
+      snapshot.AddNode(entry.node, entry.node->net_transformation_, entry.node->transformation_version_);
+      entry.node->_snapshot(snapshot);
+    }
+  }
+
+  //! \brief Draw the nodes of a snapshot. Does not touch the tree, so the simulation can run at the same time.
+  static void drawSnapshot(const node::RenderSnapshot& snapshot, MTL::RenderCommandEncoder* render_command_encoder) {
+    for (auto& state : snapshot.GetNodes()) {
+      state.node->_drawSnapshot(render_command_encoder, snapshot, state);
+    }
+  }
+
+  //! \brief Rebuild the lists of nodes with signals if the tree changed, if any node added a signal, or if nodes were
+  //!        added to or removed from the HitIndex.
+  void updateSubscribers() {
+    auto& order     = getOrder();
+    auto& hit_index = node::HitIndex::Global();
+    if (!are_subscribers_stale_ && subscribers_version_ == signals_version_
+        && hit_index_version_ == hit_index.GetVersion())
+    {
+      return;
+    }
+    polled_.clear();
+    for (auto& subscribers : subscribers_) {
+      subscribers.clear();
+    }
+    for (std::size_t position = 0; position < order.size(); ++position) {
+      auto* node = order[position].node;
+      if (hit_index.Contains(node)) {
+        continue;
+      }
+      bool is_polled      = false;
+      signal_events_t any = 0;
+      for (auto& signal : node->signals_) {
+        is_polled |= signal.GetEvents() == 0;
+        any       |= signal.GetEvents();
+      }
+      if (is_polled) {
+        polled_.push_back({position, node});
+      }
+      for (auto remaining = any; remaining != 0; remaining &= remaining - 1) {
+        subscribers_[std::countr_zero(remaining)].push_back({position, node});
+      }
+    }
+    are_subscribers_stale_ = false;
+    subscribers_version_   = signals_version_;
+    hit_index_version_     = hit_index.GetVersion();
+  }
+
+  //! \brief Get the nodes of the tree, in pre-order, rebuilding the list if the tree changed.
+  const std::vector<Entry>& getOrder() {
+    if (!is_order_stale_) {
+      return order_;
+    }
+    order_.clear();
+    std::size_t max_depth = 0;
+    std::vector<Entry> stack {{this, 0, 0}};
+    while (!stack.empty()) {
+      auto entry = stack.back();
+      stack.pop_back();
+      order_.push_back(entry);
+      max_depth = std::max(max_depth, entry.depth);
+      for (auto& child : std::views::reverse(entry.node->children_)) {
+        stack.push_back({child.get(), entry.depth + 1, 0});
+      }
+    }
+    // A node's subtree ends at the next node that is no deeper than it.
+    std::vector<std::size_t> open;
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+      while (!open.empty() && order_[i].depth <= order_[open.back()].depth) {
+        order_[open.back()].end = i;
+        open.pop_back();
+      }
+      open.push_back(i);
+    }
+    for (auto i : open) {
+      order_[i].end = order_.size();
+    }
+    updated_at_depth_.assign(max_depth + 1, false);
+    world_at_depth_.assign(max_depth + 2, nullptr);
+    is_order_stale_        = false;
+    are_subscribers_stale_ = true;
+    return order_;
+  }
+
+  //! \brief The nodes of the tree, the scene first, in pre-order.
+  std::vector<Entry> order_;
+  bool is_order_stale_ = true;
+
+  // Per-depth state of the phases that pass something from parents to children.
+
+  std::vector<bool> updated_at_depth_;
+  std::vector<world::World*> world_at_depth_;
+
+  //! \brief The parallel-safe subtrees found during the current phase.
+  std::vector<ParallelTask> parallel_tasks_;
+
+  // Nodes with signals, in the order of the tree.
+
+  //! \brief Nodes with signals that are checked every frame.
+  std::vector<Subscriber> polled_;
+  //! \brief The nodes subscribed to each event.
+  std::array<std::vector<Subscriber>, std::numeric_limits<signal_events_t>::digits> subscribers_;
+  //! \brief The nodes whose signals are due this frame.
+  std::vector<Subscriber> due_;
+  bool are_subscribers_stale_ = true;
+  std::size_t subscribers_version_ {};
+  std::size_t hit_index_version_ {};
 };
 
 }  // namespace pixelengine
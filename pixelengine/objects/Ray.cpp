@@ -0,0 +1,13 @@
+#include "pixelengine/objects/Ray.h"
+
+namespace pixelengine::objects {
+
+void Ray::_interactWithWorld(world::World* world) {
+  if (!world) {
+    hit_ = {};
+    return;
+  }
+  hit_ = world::CastRay(*world, {GetNetPosition(), direction_, length_});
+}
+
+}  // namespace pixelengine::objects
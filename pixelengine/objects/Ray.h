@@ -5,15 +5,36 @@
 #pragma once
 
 #include "pixelengine/node/Node.h"
+#include "pixelengine/world/RayCast.h"
 
 namespace pixelengine::objects {
 
+//! \brief A ray that starts at the node's position and is cast against the world every physics update, e.g. to
+//!        find what a character is looking at or where a laser stops.
 class Ray : public Node {
 public:
+  Ray() = default;
+  Ray(Vec2 direction, float length) : direction_(direction), length_(length) {}
+
+  //! \brief Set the direction of the ray, relative to the node's position. Does not have to be normalized.
+  void SetDirection(Vec2 direction) { direction_ = direction; }
+
+  //! \brief Set how far, in squares, the ray reaches.
+  void SetLength(float length) { length_ = length; }
+
+  [[nodiscard]] Vec2 GetDirection() const { return direction_; }
+  [[nodiscard]] float GetLength() const { return length_; }
+
+  //! \brief Get the result of the last time the ray was cast.
+  [[nodiscard]] const world::RayHit& GetHit() const { return hit_; }
 
 protected:
+  void _interactWithWorld(world::World* world) override;
 
+  Vec2 direction_ {1.f, 0.f};
+  float length_ = 10.f;
 
+  world::RayHit hit_ {};
 };
 
-}  // namespace pixelengine::objects
\ No newline at end of file
+}  // namespace pixelengine::objects
@@ -0,0 +1,74 @@
+#include "pixelengine/physics/BodyStore.h"
+// Other files.
+#include <algorithm>
+
+#include "pixelengine/utility/Contracts.h"
+
+namespace pixelengine::physics {
+
+std::size_t BodyStore::Allocate(PVec2 position, Vec2 velocity, float mass) {
+  std::size_t slot;
+  {
+    std::lock_guard lock(mutex_);
+    if (free_slots_.empty()) {
+      slot = num_slots_;
+      if (slot % block_size_ == 0) {
+        PIXEL_REQUIRE(slot / block_size_ < max_blocks_, "too many physics bodies");
+        blocks_[slot / block_size_] = std::make_unique<Block>();
+      }
+      ++num_slots_;
+    }
+    else {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    }
+  }
+  // The slot belongs to the caller now, so it can be set without the lock.
+  auto& block             = this->block(slot);
+  const auto index        = slot % block_size_;
+  block.positions[index]  = position;
+  block.velocities[index] = velocity;
+  block.forces[index]     = {};
+  block.remainders[index] = {};
+  block.masses[index]     = mass;
+  block.gravities[index]  = 0.f;
+  return slot;
+}
+
+void BodyStore::Release(std::size_t slot) {
+  // Free slots are still integrated, so they are left at rest.
+  auto& block             = this->block(slot);
+  const auto index        = slot % block_size_;
+  block.velocities[index] = {};
+  block.forces[index]     = {};
+  block.masses[index]     = 1.f;
+  block.gravities[index]  = 0.f;
+  std::lock_guard lock(mutex_);
+  free_slots_.push_back(slot);
+}
+
+void BodyStore::Integrate(float dt) {
+  const auto max_speed = max_speed_;
+  for (std::size_t begin = 0; begin < num_slots_; begin += block_size_) {
+    auto& block      = *blocks_[begin / block_size_];
+    const auto count = std::min(block_size_, num_slots_ - begin);
+    auto* velocities = block.velocities.data();
+    auto* forces     = block.forces.data();
+    auto* masses     = block.masses.data();
+    auto* gravities  = block.gravities.data();
+    // A plain loop over the arrays, so the compiler can vectorize it.
+    for (std::size_t i = 0; i < count; ++i) {
+      velocities[i].x = std::clamp(velocities[i].x + forces[i].x / masses[i] * dt, -max_speed, max_speed);
+      velocities[i].y =
+          std::clamp(velocities[i].y + (forces[i].y / masses[i] + gravities[i]) * dt, -max_speed, max_speed);
+      forces[i] = {};
+    }
+  }
+}
+
+BodyStore& BodyStore::Global() {
+  static BodyStore store;
+  return store;
+}
+
+}  // namespace pixelengine::physics
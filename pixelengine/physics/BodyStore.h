@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pixelengine/utility/Vec2.h"
+
+namespace pixelengine::physics {
+
+//! \brief Contiguous storage for the kinematic state of physics bodies, so that the velocities of every body can be
+//!        integrated in a single pass over a few arrays, instead of body by body during the walk of the scene.
+//!
+//! Bodies keep the index of their slot, which does not change for as long as the body exists. Slots are stored in
+//! fixed-size blocks that never move, so bodies can be created and destroyed from parallel subtrees (allocation is
+//! locked) while other bodies hold references to their state.
+class BodyStore {
+public:
+  //! \brief Reserve a slot for a body.
+  std::size_t Allocate(PVec2 position, Vec2 velocity, float mass);
+
+  //! \brief Free a body's slot for reuse.
+  void Release(std::size_t slot);
+
+  //! \brief Accelerate every body by the forces applied to it and by gravity, limit its speed, and clear the forces.
+  //!        Must not run at the same time as anything else that uses the store.
+  void Integrate(float dt);
+
+  [[nodiscard]] PVec2& Position(std::size_t slot) { return block(slot).positions[slot % block_size_]; }
+  [[nodiscard]] const PVec2& Position(std::size_t slot) const { return block(slot).positions[slot % block_size_]; }
+
+  [[nodiscard]] Vec2& Velocity(std::size_t slot) { return block(slot).velocities[slot % block_size_]; }
+  [[nodiscard]] const Vec2& Velocity(std::size_t slot) const { return block(slot).velocities[slot % block_size_]; }
+
+  [[nodiscard]] Vec2& Force(std::size_t slot) { return block(slot).forces[slot % block_size_]; }
+
+  //! \brief The fraction of a pixel the body has moved, but not yet been moved by.
+  [[nodiscard]] Vec2& Remainder(std::size_t slot) { return block(slot).remainders[slot % block_size_]; }
+
+  [[nodiscard]] float GetMass(std::size_t slot) const { return block(slot).masses[slot % block_size_]; }
+
+  //! \brief Set the downwards acceleration of the body.
+  void SetGravity(std::size_t slot, float gravity) { block(slot).gravities[slot % block_size_] = gravity; }
+
+  //! \brief Set the speed, in pixels per frame, that no body can move faster than along either axis.
+  void SetMaxSpeed(float max_speed) { max_speed_ = max_speed; }
+
+  [[nodiscard]] std::size_t GetNumBodies() const {
+    std::lock_guard lock(mutex_);
+    return num_slots_ - free_slots_.size();
+  }
+
+  //! \brief Get a store shared by the whole engine, created on first use. The game integrates it after every
+  //!        physics update.
+  static BodyStore& Global();
+
+private:
+  static constexpr std::size_t block_size_ = 1024;
+  static constexpr std::size_t max_blocks_ = 1024;
+
+  struct Block {
+    std::array<PVec2, block_size_> positions;
+    std::array<Vec2, block_size_> velocities;
+    std::array<Vec2, block_size_> forces;
+    std::array<Vec2, block_size_> remainders;
+    std::array<float, block_size_> masses;
+    std::array<float, block_size_> gravities;
+  };
+
+  [[nodiscard]] Block& block(std::size_t slot) { return *blocks_[slot / block_size_]; }
+  [[nodiscard]] const Block& block(std::size_t slot) const { return *blocks_[slot / block_size_]; }
+
+  //! \brief A fixed array, rather than a vector, so adding a block never moves the pointers to the others while
+  //!        they are being read.
+  std::array<std::unique_ptr<Block>, max_blocks_> blocks_;
+
+  //! \brief Guards allocating and releasing slots.
+  mutable std::mutex mutex_;
+
+  //! \brief The number of slots ever allocated, free or not.
+  std::size_t num_slots_ {};
+  std::vector<std::size_t> free_slots_;
+
+  float max_speed_ = 25.f;
+};
+
+}  // namespace pixelengine::physics
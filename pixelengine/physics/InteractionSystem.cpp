@@ -0,0 +1,50 @@
+#include "pixelengine/physics/InteractionSystem.h"
+
+namespace pixelengine::physics {
+
+void InteractionSystem::separateBodies(PhysicsBody& first, PhysicsBody& second, const world::World* world) {
+  // Earlier contacts may already have moved the bodies.
+  auto a = first.GetPosition(), b = second.GetPosition();
+  const auto aw = static_cast<long long>(first.GetWidth()), ah = static_cast<long long>(first.GetHeight());
+  const auto bw = static_cast<long long>(second.GetWidth()), bh = static_cast<long long>(second.GetHeight());
+  const auto overlap_x = std::min(a.x + aw, b.x + bw) - std::max(a.x, b.x);
+  const auto overlap_y = std::min(a.y + ah, b.y + bh) - std::max(a.y, b.y);
+  if (overlap_x <= 0 || overlap_y <= 0) {
+    return;
+  }
+
+  const bool along_x     = overlap_x <= overlap_y;
+  const auto penetration = along_x ? overlap_x : overlap_y;
+  // Whether the second body is pushed in the positive direction, and the first in the negative direction.
+  const bool second_positive = along_x ? a.x + a.x + aw <= b.x + b.x + bw : a.y + a.y + ah <= b.y + b.y + bh;
+
+  // Heavier bodies move less.
+  const auto mass_a = std::max(first.GetMass(), 1e-6f), mass_b = std::max(second.GetMass(), 1e-6f);
+  const auto share_a =
+      static_cast<long long>(std::lround(static_cast<float>(penetration) * mass_b / (mass_a + mass_b)));
+
+  auto push = [&](PhysicsBody& body, bool positive, long long steps) {
+    long long moved = 0;
+    for (; moved < steps && moveBody(body, along_x, positive, world); ++moved) {}
+    return moved;
+  };
+  // If one body is blocked by the terrain, the other moves further.
+  auto moved = push(first, !second_positive, share_a);
+  moved += push(second, second_positive, penetration - moved);
+  if (moved < penetration) {
+    push(first, !second_positive, penetration - moved);
+  }
+
+  // Stop the bodies from moving into one another.
+  auto va = first.GetVelocity(), vb = second.GetVelocity();
+  auto& component_a = along_x ? va.x : va.y;
+  auto& component_b = along_x ? vb.x : vb.y;
+  const auto closing = second_positive ? component_a - component_b : component_b - component_a;
+  if (0 < closing) {
+    component_a = component_b = (mass_a * component_a + mass_b * component_b) / (mass_a + mass_b);
+    setBodyVelocity(first, va);
+    setBodyVelocity(second, vb);
+  }
+}
+
+}  // namespace pixelengine::physics
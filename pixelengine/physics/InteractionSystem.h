@@ -1,13 +1,27 @@
 #pragma once
 
+#include <span>
+
 #include "pixelengine/physics/PhysicsBody.h"
 
 namespace pixelengine::physics {
 
+//! \brief Two bodies whose boxes overlap.
+struct Contact {
+  PhysicsBody* first {};
+  PhysicsBody* second {};
+
+  friend bool operator==(const Contact&, const Contact&) = default;
+};
+
 //! \brief All the physics bodies in an interaction are able to interact with one another.
 //!        The InteractionSystem is responsible for implementing the algorith for computing
 //!        the forces or interactions between the bodies.
-class InteractionSystem {
+//!
+//! The interaction system is a node, so it takes part in the scene's physics update. It does not own its members,
+//! and a body must be removed from the system before it is destroyed. Contacts with a removed body end without
+//! notifying either body.
+class InteractionSystem : public Node {
 public:
   void AddMember(PhysicsBody* body) {
     queued_members_.push_back(body);
@@ -19,16 +33,56 @@ public:
     body->_onRemovedFromInteractionSystem(this);
   }
 
-private:
-  void _updatePhysics(float dt) { computeInteractions(dt); }
+  //! \brief Get the pairs of bodies that overlapped during the last physics update.
+  [[nodiscard]] virtual std::span<const Contact> GetContacts() const = 0;
 
-  virtual void removeQueuedMembers() = 0;
-  virtual void addQueuedMembers()    = 0;
+protected:
+  void _updatePhysics(float dt, const world::World* world) override {
+    Node::_updatePhysics(dt, world);
+    removeQueuedMembers();
+    addQueuedMembers();
+    computeInteractions(dt, world);
+  }
+
+  // ===========================================================================
+  //  Access to the bodies, for implementations (friendship is not inherited).
+  // ===========================================================================
+
+  //! \brief Move the body one pixel along an axis, unless the world blocks it. Without a world, the body always
+  //!        moves.
+  static bool moveBody(PhysicsBody& body, bool along_x, bool positive, const world::World* world) {
+    if (!world) {
+      (along_x ? body.position().x : body.position().y) += positive ? 1 : -1;
+      return true;
+    }
+    return along_x ? body.moveX(positive, *world) : body.moveY(positive, *world);
+  }
 
-  virtual void computeInteractions(float dt) = 0;
+  static void setBodyVelocity(PhysicsBody& body, Vec2 velocity) { body.velocity() = velocity; }
+
+  static void beginContact(const Contact& contact) {
+    contact.first->_onContactBegin(contact.second);
+    contact.second->_onContactBegin(contact.first);
+  }
+
+  static void endContact(const Contact& contact) {
+    contact.first->_onContactEnd(contact.second);
+    contact.second->_onContactEnd(contact.first);
+  }
+
+  //! \brief If two bodies overlap, push them apart along the axis of least penetration, heavier bodies moving less,
+  //!        and without pushing either body into the terrain. Their velocities along that axis are made equal if
+  //!        they were moving towards one another.
+  static void separateBodies(PhysicsBody& first, PhysicsBody& second, const world::World* world);
 
   std::vector<PhysicsBody*> queued_members_;
   std::vector<PhysicsBody*> queued_for_removal_;
+
+private:
+  virtual void removeQueuedMembers() = 0;
+  virtual void addQueuedMembers()    = 0;
+
+  virtual void computeInteractions(float dt, const world::World* world) = 0;
 };
 
-}  // namespace pixelengine::physics
\ No newline at end of file
+}  // namespace pixelengine::physics
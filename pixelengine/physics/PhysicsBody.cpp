@@ -8,89 +8,77 @@
 
 namespace pixelengine::physics {
 
-PhysicsBody::PhysicsBody(PVec2 position, unsigned width, unsigned height, Vec2 velocity)
-    : position_(position)
-    , velocity_(velocity)
+PhysicsBody::PhysicsBody(PVec2 position, unsigned width, unsigned height, Vec2 velocity, BodyStore& store)
+    : store_(&store)
+    , slot_(store.Allocate(position, velocity, 1.f))
     , width_(width)
     , height_(height) {}
 
+PhysicsBody::~PhysicsBody() {
+  store_->Release(slot_);
+}
+
 void PhysicsBody::clearVelocity() {
-  velocity_ = {};
+  velocity() = {};
 }
 
 void PhysicsBody::addVelocityX(float dvx) {
-  velocity_.x += dvx;
+  velocity().x += dvx;
 }
 
 void PhysicsBody::addVelocityY(float dvy) {
-  velocity_.y += dvy;
+  velocity().y += dvy;
 }
 
 void PhysicsBody::applyForceX(float fx) {
-  force_.x += fx;
+  force().x += fx;
 }
 
 void PhysicsBody::applyForceY(float fy) {
-  force_.y += fy;
+  force().y += fy;
 }
 
 void PhysicsBody::_interactWithWorld(world::World* world) {
   Node::_interactWithWorld(world);
   if (world) {
+    store_->SetGravity(slot_, gravity_scale_ * world->GetGravity());
     moveBody(*world);
   }
 }
 
-void PhysicsBody::_updatePhysics(float dt, const world::World* world) {
-  Node::_updatePhysics(dt, world);
-  updateBodyPhysics(dt, world);
-}
-
-void PhysicsBody::updateBodyPhysics(float dt, [[maybe_unused]] const world::World* world) {
-  // Update the position of the body based on the velocity and the time step.
-
-  // TODO: Get gravity from somewhere.... like the world.
-  force_.y -= 25.f * mass_;
-
-  velocity_.x += force_.x * dt / mass_;
-  velocity_.y += force_.y * dt / mass_;
-
-  // Limit velocity?
-  velocity_.x = std::clamp(velocity_.x, -25.f, 25.f);
-  velocity_.y = std::clamp(velocity_.y, -25.f, 25.f);
-
-  force_ = {};  // Reset force.
-
-  // TODO: More complex?
-  // if (state_.blocked_down) {
-  //   const float mu = 0.;
-  //   if (velocity_.x < 0) {
-  //     velocity_.x -= mu * mass_;
-  //     velocity_.x = std::max(velocity_.x, 0.f);
-  //   }
-  //   else if (velocity_.x > 0) {
-  //     velocity_.x += mu * mass_;
-  //     velocity_.x = std::min(velocity_.x, 0.f);
-  //   }
-  //
-  //   if (velocity_.x == 0) {
-  //     remainder_.x = 0;
-  //   }
-  // }
-}
-
 void PhysicsBody::moveBody(world::World& world) {
   // Put the velocity into the remainder.
-  remainder_ += velocity_;
+  remainder() += velocity();
+
+  auto [end_position, new_remainder] = AddWithRemainder(position(), remainder());
+  remainder()                        = new_remainder;
+
+  // A body resting on the ground, whose surroundings have not changed, cannot move down. This is the usual case for
+  // idle bodies, which are pulled down every frame.
+  if (end_position.x == position().x && end_position.y < position().y && state_.blocked_down
+      && isStateCurrent(world)) {
+    remainder().y = 0.f;
+    velocity().y  = 0.f;
+    end_position = position();
+  }
 
-  auto [end_position, new_remainder_] = AddWithRemainder(position_, remainder_);
-  remainder_                          = new_remainder_;
+  // The points of the path, after the starting point.
+  thread_local std::vector<PVec2> path;
+  path.clear();
+  PathGenerator generator(position(), end_position);
+  generator.Next();
+  while (auto next = generator.Next()) {
+    path.push_back(*next);
+  }
+
+  // Nothing can happen until the first impact, so skip straight to it. From there on, the body is moved a pixel at a
+  // time, so it can be blocked or step up.
+  auto impact = sweep(path, world);
 
-  PathGenerator generator(position_, end_position);
   bool blocked_x = false, blocked_y = false;
-  while (auto next = generator.Next()) {
-    if (!blocked_x && next->x != position_.x) {
-      auto move_right = next->x > position_.x;
+  for (auto next = path.begin() + static_cast<std::ptrdiff_t>(impact); next != path.end(); ++next) {
+    if (!blocked_x && next->x != position().x) {
+      auto move_right = next->x > position().x;
       if (!moveX(move_right, world)) {
         // If stepping is allowed, try to step.
         if (can_step_ && tryStep(move_right, world)) {
@@ -98,172 +86,168 @@ void PhysicsBody::moveBody(world::World& world) {
         }
         // Else, or if stepping failed.
         blocked_x    = true;
-        remainder_.x = 0.f;
-        velocity_.x  = 0.f;
+        remainder().x = 0.f;
+        velocity().x  = 0.f;
       }
     }
-    if (!blocked_y && next->y != position_.y) {
-      if (!moveY(next->y > position_.y, world)) {
+    if (!blocked_y && next->y != position().y) {
+      if (!moveY(next->y > position().y, world)) {
         blocked_y    = true;
-        remainder_.y = 0.f;
-        velocity_.y  = 0.f;
+        remainder().y = 0.f;
+        velocity().y  = 0.f;
       }
     }
   }
 
-  // Check for collisions.
-
-  // Find the pixels that surround the body.
-  auto bottom = position_.y;
-  auto top    = position_.y + height_;
-  auto left   = position_.x;
-  auto right  = position_.x + width_;
-
-  BodyState new_state;
-
-  // Check left side.
-  for (auto y = bottom; y < top; ++y) {
-    if (!world.IsValidSquare(left - 1, y)) {
-      new_state.blocked_left = true;
-      break;
-    }
-    auto&& square = world.GetSquare(left - 1, y);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      new_state.blocked_left = true;
-      break;
-    }
-  }
-
-  // Check right side.
-  for (auto y = bottom; y < top; ++y) {
-    if (!world.IsValidSquare(right + 1, y)) {
-      new_state.blocked_right = true;
-      break;
-    }
-    auto&& square = world.GetSquare(right + 1, y);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      new_state.blocked_right = true;
-      break;
-    }
-  }
-
-  // Check top side.
-  for (auto x = left; x < right; ++x) {
-    if (!world.IsValidSquare(x, top + 1)) {
-      new_state.blocked_up = true;
-      break;
-    }
-    auto&& square = world.GetSquare(x, top + 1);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      new_state.blocked_up = true;
-      break;
-    }
+  last_state_ = state_;
+  if (!isStateCurrent(world)) {
+    updateState(world);
   }
+}
 
-  // Check bottom side.
-  for (auto x = left; x < right; ++x) {
-    if (!world.IsValidSquare(x, bottom - 1)) {
-      new_state.blocked_down = true;
-      break;
-    }
-    auto&& square = world.GetSquare(x, bottom - 1);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      new_state.blocked_down = true;
-      break;
-    }
+bool PhysicsBody::isStateCurrent(const world::World& world) const {
+  auto* tracker = world.GetChangeTracker();
+  if (!tracker || !state_record_.is_valid || state_record_.position != position()) {
+    return false;
   }
+  return tracker->GetVersion(surroundings()) <= state_record_.version;
+}
 
-  // ========================
-  // Check corners
-  // ========================
+world::BoundingBox PhysicsBody::surroundings() const {
+  return {position().x - 1,
+          position().x + static_cast<long long>(width_) + 1,
+          position().y - 1,
+          position().y + static_cast<long long>(height_) + 1};
+}
 
-  auto check_corner = [&](long long x, long long y) {
-    if (!world.IsValidSquare(x, y)) {
-      return true;
-    }
-    auto&& square = world.GetSquare(x, y);
-    return square.is_occupied && square.material->IsSolidOrPowder();
+void PhysicsBody::updateState(const world::World& world) {
+  // Find the pixels that surround the body.
+  auto bottom = position().y;
+  auto top    = position().y + height_;
+  auto left   = position().x;
+  auto right  = position().x + width_;
+
+  // Each side is a thin rectangle, so checking it is a single count.
+  auto is_blocked = [&](long long x_min, long long x_max, long long y_min, long long y_max) {
+    return x_min <= x_max && y_min <= y_max && 0 < world.CountSquares({x_min, x_max, y_min, y_max}).solid;
   };
 
-  // Top left corner
-  check_corner(left - 1, top + 1);
-  // Top right corner
-  check_corner(right + 1, top + 1);
-  // Bottom left corner
-  check_corner(left - 1, bottom - 1);
-  // Bottom right corner
-  check_corner(right + 1, bottom - 1);
+  state_.blocked_left  = is_blocked(left - 1, left - 1, bottom, top - 1);
+  state_.blocked_right = is_blocked(right + 1, right + 1, bottom, top - 1);
+  state_.blocked_up    = is_blocked(left, right - 1, top + 1, top + 1);
+  state_.blocked_down  = is_blocked(left, right - 1, bottom - 1, bottom - 1);
 
-  last_state_ = state_;
-  state_      = new_state;
+  state_.blocked_top_left     = is_blocked(left - 1, left - 1, top + 1, top + 1);
+  state_.blocked_top_right    = is_blocked(right + 1, right + 1, top + 1, top + 1);
+  state_.blocked_bottom_left  = is_blocked(left - 1, left - 1, bottom - 1, bottom - 1);
+  state_.blocked_bottom_right = is_blocked(right + 1, right + 1, bottom - 1, bottom - 1);
+
+  auto* tracker = world.GetChangeTracker();
+  state_record_ = {tracker != nullptr, position(), tracker ? tracker->GetVersion() : 0};
 }
 
-bool PhysicsBody::moveX(bool right, world::World& world) {
-  long long column = right ? position_.x + width_ : position_.x - 1;
+std::size_t PhysicsBody::sweep(std::span<const PVec2> path, const world::World& world) {
+  const auto start = position();
+  const auto width = static_cast<long long>(width_), height = static_cast<long long>(height_);
+  // The path moves monotonically along each axis, so on the way to its position after `count` points, the body only
+  // enters squares in the box around its start and end positions, and outside its starting box. That is at most two
+  // strips, one beside the starting box and one above or below it. If they are clear, so was every move.
+  auto is_clear = [&](std::size_t count) {
+    if (count == 0) {
+      return true;
+    }
+    auto& end = path[count - 1];
+    if (end.x != start.x) {
+      auto x_min = end.x < start.x ? end.x : start.x + width;
+      auto x_max = end.x < start.x ? start.x - 1 : end.x + width - 1;
+      auto y_min = std::min(start.y, end.y), y_max = std::max(start.y, end.y) + height - 1;
+      if (0 < world.CountSquares({x_min, x_max, y_min, y_max}).solid) {
+        return false;
+      }
+    }
+    if (end.y != start.y) {
+      auto y_min = end.y < start.y ? end.y : start.y + height;
+      auto y_max = end.y < start.y ? start.y - 1 : end.y + height - 1;
+      if (0 < world.CountSquares({start.x, start.x + width - 1, y_min, y_max}).solid) {
+        return false;
+      }
+    }
+    return true;
+  };
 
-  for (auto y = position_.y; y < position_.y + height_; ++y) {
-    if (!world.IsValidSquare(column, y)) {
-      return false;
+  // Usually the whole path is clear, which takes a single check. Otherwise, the impact is searched for by
+  // galloping from the start, since resting bodies are often blocked right away.
+  std::size_t reached = path.size();
+  if (!is_clear(reached)) {
+    std::size_t low = 0, high = path.size() - 1;
+    for (std::size_t stride = 1; low + stride <= high; stride *= 2) {
+      if (!is_clear(low + stride)) {
+        high = low + stride - 1;
+        break;
+      }
+      low += stride;
     }
-    auto&& square = world.GetSquare(column, y);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      return false;
+    while (low < high) {
+      auto middle = (low + high + 1) / 2;
+      if (is_clear(middle)) {
+        low = middle;
+      }
+      else {
+        high = middle - 1;
+      }
     }
+    reached = low;
+  }
+  if (0 < reached) {
+    position() = path[reached - 1];
+  }
+  return reached;
+}
+
+bool PhysicsBody::moveX(bool right, const world::World& world) {
+  long long column = right ? position().x + width_ : position().x - 1;
+  if (0 < world.CountSquares({column, column, position().y, position().y + height_ - 1}).solid) {
+    return false;
   }
 
-  position_.x += right ? 1 : -1;
+  position().x += right ? 1 : -1;
 
   return true;
 }
 
-bool PhysicsBody::moveY(bool up, world::World& world) {
-  long long row = up ? position_.y + height_ : position_.y - 1;
-
-  for (auto x = position_.x; x < position_.x + width_; ++x) {
-    if (!world.IsValidSquare(x, row)) {
-      return false;
-    }
-    auto&& square = world.GetSquare(x, row);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      return false;
-    }
+bool PhysicsBody::moveY(bool up, const world::World& world) {
+  long long row = up ? position().y + height_ : position().y - 1;
+  if (0 < world.CountSquares({position().x, position().x + width_ - 1, row, row}).solid) {
+    return false;
   }
 
-  position_.y += up ? 1 : -1;
+  position().y += up ? 1 : -1;
 
   return true;
 }
 
-bool PhysicsBody::isBlockedDown(world::World& world) const {
-  long long row = position_.y - 1;
-  for (auto x = position_.x; x < position_.x + width_; ++x) {
-    if (!world.IsValidSquare(x, row)) {
-      return true;
-    }
-    auto&& square = world.GetSquare(x, row);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      return true;
-    }
-  }
-  return false;
+bool PhysicsBody::isBlockedDown(const world::World& world) const {
+  long long row = position().y - 1;
+  return 0 < world.CountSquares({position().x, position().x + width_ - 1, row, row}).solid;
 }
 
-unsigned PhysicsBody::heightOfStep(bool right, world::World& world) const {
-  long long column = right ? position_.x + width_ : position_.x - 1;
+unsigned PhysicsBody::heightOfStep(bool right, const world::World& world) const {
+  long long column = right ? position().x + width_ : position().x - 1;
 
-  for (auto y = position_.y + height_ - 1; 0 <= y; --y) {
-    if (!world.IsValidSquare(column, y)) {
-      return y - position_.y + 1;
-    }
-    auto&& square = world.GetSquare(column, y);
-    if (square.is_occupied && square.material->IsSolidOrPowder()) {
-      return y - position_.y + 1;
+  // Anything blocking above the step limit makes the step too tall, whatever is below it.
+  const auto limit = position().y + static_cast<long long>(stepping_height_);
+  if (0 < world.CountSquares({column, column, limit, position().y + static_cast<long long>(height_) - 1}).solid) {
+    return stepping_height_ + 1;
+  }
+  for (auto y = std::min(limit, position().y + static_cast<long long>(height_)) - 1; position().y <= y; --y) {
+    if (0 < world.CountSquares({column, column, y, y}).solid) {
+      return static_cast<unsigned>(y - position().y + 1);
     }
   }
   return 0;
 }
 
-bool PhysicsBody::tryStep(bool move_right, world::World& world) {
+bool PhysicsBody::tryStep(bool move_right, const world::World& world) {
   // Stepping logic. Body must be on the ground to step.
   // Count the height of the highest blocker. If it is short enough, move up that number of times,
   // then move in the X direction.
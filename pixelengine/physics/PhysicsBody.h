@@ -1,6 +1,8 @@
 #pragma once
 
 #include "pixelengine/node/Node.h"
+#include "pixelengine/physics/BodyStore.h"
+#include "pixelengine/world/ChangeTracker.h"
 #include "pixelengine/world/World.h"
 
 namespace pixelengine::physics {
@@ -50,19 +52,38 @@ class PhysicsBody : public Node {
   friend class InteractionSystem;
 
 public:
-  PhysicsBody(PVec2 position, unsigned width, unsigned height, Vec2 velocity = {});
+  //! \brief Create a body, whose kinematic state is kept in the store. The store must outlive the body, and be
+  //!        integrated after every physics update.
+  PhysicsBody(PVec2 position,
+              unsigned width,
+              unsigned height,
+              Vec2 velocity     = {},
+              BodyStore& store = BodyStore::Global());
 
-  [[nodiscard]] Vec2 GetVelocity() const { return velocity_; }
+  ~PhysicsBody() override;
+
+  [[nodiscard]] Vec2 GetVelocity() const { return store_->Velocity(slot_); }
 
   [[nodiscard]] const BodyState& GetState() const noexcept { return state_; }
 
-  [[nodiscard]] PVec2 GetPosition() const noexcept { return position_; }
+  [[nodiscard]] PVec2 GetPosition() const noexcept { return store_->Position(slot_); }
+
+  [[nodiscard]] float GetMass() const noexcept { return store_->GetMass(slot_); }
+
+  [[nodiscard]] unsigned GetWidth() const noexcept { return width_; }
+  [[nodiscard]] unsigned GetHeight() const noexcept { return height_; }
+
+  //! \brief Get the tallest step, in pixels, that the body can walk up, zero if the body cannot step.
+  [[nodiscard]] unsigned GetSteppingHeight() const noexcept { return can_step_ ? stepping_height_ : 0; }
 
 protected:
   void clearVelocity();
 
-  void setVelocityX(float vx) { velocity_.x = vx; }
-  void setVelocityY(float vy) { velocity_.y = vy; }
+  void setVelocityX(float vx) { velocity().x = vx; }
+  void setVelocityY(float vy) { velocity().y = vy; }
+
+  //! \brief Set how strongly the world's gravity pulls on the body.
+  void setGravityScale(float scale) { gravity_scale_ = scale; }
 
   void addVelocityX(float dvx);
   void addVelocityY(float dvy);
@@ -73,28 +94,48 @@ protected:
   virtual void _onAddedToInteractionSystem([[maybe_unused]] InteractionSystem* interaction_system) {}
   virtual void _onRemovedFromInteractionSystem([[maybe_unused]] InteractionSystem* interaction_system) {}
 
+  //! \brief Called when the body starts overlapping another body in the same interaction system.
+  virtual void _onContactBegin([[maybe_unused]] PhysicsBody* other) {}
+  //! \brief Called when the body stops overlapping another body in the same interaction system.
+  virtual void _onContactEnd([[maybe_unused]] PhysicsBody* other) {}
+
 private:
   void _interactWithWorld(world::World* world) override;
-  void _updatePhysics(float dt, const world::World* world) override;
 
-  void updateBodyPhysics(float dt, const world::World* world);
+  [[nodiscard]] PVec2& position() { return store_->Position(slot_); }
+  [[nodiscard]] const PVec2& position() const { return store_->Position(slot_); }
+  [[nodiscard]] Vec2& velocity() { return store_->Velocity(slot_); }
+  [[nodiscard]] Vec2& force() { return store_->Force(slot_); }
+  [[nodiscard]] Vec2& remainder() { return store_->Remainder(slot_); }
   void moveBody(world::World& world);
 
-  bool moveX(bool right, world::World& world);
-  bool moveY(bool up, world::World& world);
+  //! \brief Move the body along the path up to the first point where it could hit the terrain, and return the number
+  //!        of points it moved through.
+  std::size_t sweep(std::span<const PVec2> path, const world::World& world);
 
-  [[nodiscard]] bool isBlockedDown(world::World& world) const;
+  bool moveX(bool right, const world::World& world);
+  bool moveY(bool up, const world::World& world);
 
-  //! \brief Returns the height of the step to the left or right, in pixels.
-  [[nodiscard]] unsigned heightOfStep(bool move_right, world::World& world) const;
+  [[nodiscard]] bool isBlockedDown(const world::World& world) const;
 
-  bool tryStep(bool move_right, world::World& world);
+  //! \brief Whether the body's state was found at its current position, and nothing around the body changed since.
+  [[nodiscard]] bool isStateCurrent(const world::World& world) const;
 
-  //! The position (bottom left corner) of the physics body.
-  PVec2 position_ {};
-  Vec2 velocity_ {};
-  Vec2 force_ {};
-  Vec2 remainder_ {};
+  //! \brief The squares whose contents make up the body's state.
+  [[nodiscard]] world::BoundingBox surroundings() const;
+
+  //! \brief Find which of the squares around the body are blocked.
+  void updateState(const world::World& world);
+
+  //! \brief Returns the height of the step to the left or right, in pixels, or one more than the stepping height if
+  //!        the step is any taller than that.
+  [[nodiscard]] unsigned heightOfStep(bool move_right, const world::World& world) const;
+
+  bool tryStep(bool move_right, const world::World& world);
+
+  //! \brief Where the body's position (its bottom left corner), velocity, etc. are kept.
+  BodyStore* store_;
+  std::size_t slot_;
 
   //! \brief The body width and height in pixels.
   //!
@@ -104,9 +145,19 @@ private:
   bool can_step_ {true};
   unsigned stepping_height_ = 4;
 
-  float mass_ = 1.;
+  //! \brief Bodies' velocities are in pixels per frame, so they are pulled on more weakly than squares. The default
+  //!        gives the bodies' tuned acceleration of 25 pixels per frame per second in a world with a gravity of -100.
+  float gravity_scale_ = 0.25f;
 
   BodyState state_ {}, last_state_ {};
+
+  //! \brief Where, and as of which version of the world, the state was found. Only valid if the world tracks its
+  //!        changes.
+  struct {
+    bool is_valid = false;
+    PVec2 position {};
+    uint64_t version = 0;
+  } state_record_;
 };
 
 }  // namespace pixelengine::physics
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "pixelengine/physics/SpatialHashInteractionSystem.h"
+// Other files.
+#include <bit>
+
+namespace pixelengine::physics {
+
+namespace {
+
+long long floorDivide(long long value, long long divisor) {
+  auto quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+}  // namespace
+
+SpatialHashInteractionSystem::SpatialHashInteractionSystem(long long cell_size)
+    : cell_size_(cell_size) {
+  PIXEL_ASSERT(0 < cell_size, "cell size must be positive");
+}
+
+void SpatialHashInteractionSystem::removeQueuedMembers() {
+  if (queued_for_removal_.empty()) {
+    return;
+  }
+  std::erase_if(members_, [this](PhysicsBody* body) {
+    return std::ranges::find(queued_for_removal_, body) != queued_for_removal_.end();
+  });
+  // A body may be removed before it was ever added.
+  std::erase_if(queued_members_, [this](PhysicsBody* body) {
+    return std::ranges::find(queued_for_removal_, body) != queued_for_removal_.end();
+  });
+  // Removed bodies may already be gone, so their contacts end without notice.
+  std::erase_if(previous_contacts_, [this](const Contact& contact) {
+    return std::ranges::find(queued_for_removal_, contact.first) != queued_for_removal_.end()
+        || std::ranges::find(queued_for_removal_, contact.second) != queued_for_removal_.end();
+  });
+  queued_for_removal_.clear();
+}
+
+void SpatialHashInteractionSystem::addQueuedMembers() {
+  members_.insert(members_.end(), queued_members_.begin(), queued_members_.end());
+  queued_members_.clear();
+}
+
+void SpatialHashInteractionSystem::computeInteractions([[maybe_unused]] float dt, const world::World* world) {
+  contacts_.clear();
+  if (2 <= members_.size()) {
+    buildHash();
+    findContacts();
+  }
+  notifyContacts();
+  for (auto& contact : contacts_) {
+    separateBodies(*contact.first, *contact.second, world);
+  }
+}
+
+void SpatialHashInteractionSystem::notifyContacts() {
+  // The hash is rebuilt every update, so contacts that began or ended are found by comparing with the last update.
+  auto by_bodies = [](const Contact& a, const Contact& b) {
+    return std::tie(a.first, a.second) < std::tie(b.first, b.second);
+  };
+  current_contacts_.assign(contacts_.begin(), contacts_.end());
+  std::ranges::sort(current_contacts_, by_bodies);
+  std::ranges::set_difference(current_contacts_,
+                              previous_contacts_,
+                              std::back_inserter(changed_contacts_),
+                              by_bodies);
+  for (auto& contact : changed_contacts_) {
+    beginContact(contact);
+  }
+  changed_contacts_.clear();
+  std::ranges::set_difference(previous_contacts_,
+                              current_contacts_,
+                              std::back_inserter(changed_contacts_),
+                              by_bodies);
+  for (auto& contact : changed_contacts_) {
+    endContact(contact);
+  }
+  changed_contacts_.clear();
+  std::swap(previous_contacts_, current_contacts_);
+}
+
+void SpatialHashInteractionSystem::buildHash() {
+  bounds_.clear();
+  std::size_t num_entries = 0;
+  for (auto* body : members_) {
+    auto position = body->GetPosition();
+    BodyBounds bounds;
+    bounds.x_min      = position.x;
+    bounds.x_max      = position.x + std::max(1ll, static_cast<long long>(body->GetWidth())) - 1;
+    bounds.y_min      = position.y;
+    bounds.y_max      = position.y + std::max(1ll, static_cast<long long>(body->GetHeight())) - 1;
+    bounds.cell_x_min = floorDivide(bounds.x_min, cell_size_);
+    bounds.cell_x_max = floorDivide(bounds.x_max, cell_size_);
+    bounds.cell_y_min = floorDivide(bounds.y_min, cell_size_);
+    bounds.cell_y_max = floorDivide(bounds.y_max, cell_size_);
+    num_entries += static_cast<std::size_t>((bounds.cell_x_max - bounds.cell_x_min + 1)
+                                            * (bounds.cell_y_max - bounds.cell_y_min + 1));
+    bounds_.push_back(bounds);
+  }
+
+  // Twice as many buckets as entries keeps collisions between cells rare.
+  auto num_buckets = std::bit_ceil(std::max<std::size_t>(16, 2 * num_entries));
+  bucket_mask_     = num_buckets - 1;
+
+  // Counting sort of the entries by bucket.
+  bucket_starts_.assign(num_buckets + 1, 0);
+  for (auto& bounds : bounds_) {
+    for (auto cy = bounds.cell_y_min; cy <= bounds.cell_y_max; ++cy) {
+      for (auto cx = bounds.cell_x_min; cx <= bounds.cell_x_max; ++cx) {
+        ++bucket_starts_[bucketOf(cx, cy) + 1];
+      }
+    }
+  }
+  for (std::size_t i = 0; i < num_buckets; ++i) {
+    bucket_starts_[i + 1] += bucket_starts_[i];
+  }
+  entries_.resize(num_entries);
+  for (uint32_t body = 0; body < bounds_.size(); ++body) {
+    auto& bounds = bounds_[body];
+    for (auto cy = bounds.cell_y_min; cy <= bounds.cell_y_max; ++cy) {
+      for (auto cx = bounds.cell_x_min; cx <= bounds.cell_x_max; ++cx) {
+        // Uses the start of the next bucket as a cursor, so afterwards it holds the start of this bucket.
+        entries_[bucket_starts_[bucketOf(cx, cy)]++] = {cx, cy, body};
+      }
+    }
+  }
+  for (auto i = num_buckets; 0 < i; --i) {
+    bucket_starts_[i] = bucket_starts_[i - 1];
+  }
+  bucket_starts_[0] = 0;
+}
+
+void SpatialHashInteractionSystem::findContacts() {
+  for (std::size_t bucket = 0; bucket + 1 < bucket_starts_.size(); ++bucket) {
+    const auto begin = bucket_starts_[bucket], end = bucket_starts_[bucket + 1];
+    for (auto i = begin; i < end; ++i) {
+      auto& entry = entries_[i];
+      auto& a     = bounds_[entry.body];
+      for (auto j = i + 1; j < end; ++j) {
+        auto& other = entries_[j];
+        // Different cells can share a bucket.
+        if (other.cell_x != entry.cell_x || other.cell_y != entry.cell_y) {
+          continue;
+        }
+        auto& b = bounds_[other.body];
+        // Bodies can share several cells. Only test them in the cell that holds the bottom left corner of the
+        // overlap of their cell ranges.
+        if (entry.cell_x != std::max(a.cell_x_min, b.cell_x_min)
+            || entry.cell_y != std::max(a.cell_y_min, b.cell_y_min)) {
+          continue;
+        }
+        if (a.x_min <= b.x_max && b.x_min <= a.x_max && a.y_min <= b.y_max && b.y_min <= a.y_max) {
+          auto first = std::min(entry.body, other.body), second = std::max(entry.body, other.body);
+          contacts_.push_back({members_[first], members_[second]});
+        }
+      }
+    }
+  }
+}
+
+std::size_t SpatialHashInteractionSystem::bucketOf(long long cell_x, long long cell_y) const {
+  auto hash = static_cast<uint64_t>(cell_x) * 0x9E3779B97F4A7C15ull
+            ^ static_cast<uint64_t>(cell_y) * 0xC2B2AE3D27D4EB4Full;
+  return static_cast<std::size_t>(hash ^ (hash >> 32)) & bucket_mask_;
+}
+
+}  // namespace pixelengine::physics
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "pixelengine/physics/InteractionSystem.h"
+
+namespace pixelengine::physics {
+
+//! \brief An interaction system that keeps its bodies from passing through one another, finding overlapping bodies
+//!        with a spatial hash.
+//!
+//! Every physics update, the bodies' boxes are hashed into a uniform grid of cells, and only bodies that share a
+//! cell are tested against each other. Overlapping bodies are then pushed apart.
+class SpatialHashInteractionSystem : public InteractionSystem {
+public:
+  //! \brief Create the system. Cells should be about as large as a typical body.
+  explicit SpatialHashInteractionSystem(long long cell_size = 16);
+
+  [[nodiscard]] std::span<const Contact> GetContacts() const override { return contacts_; }
+
+  [[nodiscard]] std::size_t GetNumMembers() const { return members_.size(); }
+
+private:
+  //! \brief A body's box, in pixels and in cells (all bounds inclusive).
+  struct BodyBounds {
+    long long x_min, x_max, y_min, y_max;
+    long long cell_x_min, cell_x_max, cell_y_min, cell_y_max;
+  };
+
+  //! \brief One cell that a body overlaps.
+  struct CellEntry {
+    long long cell_x, cell_y;
+    uint32_t body;
+  };
+
+  void removeQueuedMembers() override;
+  void addQueuedMembers() override;
+
+  void computeInteractions(float dt, const world::World* world) override;
+
+  //! \brief Hash every body into the cells its box overlaps.
+  void buildHash();
+
+  //! \brief Find the overlapping pairs of bodies, each pair once.
+  void findContacts();
+
+  //! \brief Notify the bodies of contacts that began or ended since the last update.
+  void notifyContacts();
+
+  [[nodiscard]] std::size_t bucketOf(long long cell_x, long long cell_y) const;
+
+  long long cell_size_;
+  //! \brief The number of buckets is a power of two, so the bucket is the hash masked by this.
+  std::size_t bucket_mask_ = 0;
+
+  std::vector<PhysicsBody*> members_;
+
+  // Scratch space, reused every update.
+
+  std::vector<BodyBounds> bounds_;
+  //! \brief Cell entries, grouped by bucket.
+  std::vector<CellEntry> entries_;
+  //! \brief Where each bucket's entries start, with one extra entry at the end.
+  std::vector<uint32_t> bucket_starts_;
+  std::vector<Contact> contacts_;
+
+  //! \brief The contacts of the last and current updates, sorted by body, and those that changed.
+  std::vector<Contact> previous_contacts_, current_contacts_, changed_contacts_;
+};
+
+}  // namespace pixelengine::physics
@@ -0,0 +1,213 @@
+#include "pixelengine/physics/SweepAndPruneInteractionSystem.h"
+
+namespace pixelengine::physics {
+
+void SweepAndPruneInteractionSystem::removeQueuedMembers() {
+  if (queued_for_removal_.empty()) {
+    return;
+  }
+  auto is_removed = [this](PhysicsBody* body) {
+    return std::ranges::find(queued_for_removal_, body) != queued_for_removal_.end();
+  };
+  std::erase_if(members_, is_removed);
+  // A body may be removed before it was ever added.
+  std::erase_if(queued_members_, is_removed);
+  // Removed bodies may already be gone, so their contacts end without notice.
+  std::erase_if(contacts_,
+                [&](const Contact& contact) { return is_removed(contact.first) || is_removed(contact.second); });
+  queued_for_removal_.clear();
+  needs_rebuild_ = true;
+}
+
+void SweepAndPruneInteractionSystem::addQueuedMembers() {
+  if (queued_members_.empty()) {
+    return;
+  }
+  members_.insert(members_.end(), queued_members_.begin(), queued_members_.end());
+  queued_members_.clear();
+  needs_rebuild_ = true;
+}
+
+void SweepAndPruneInteractionSystem::computeInteractions([[maybe_unused]] float dt, const world::World* world) {
+  if (needs_rebuild_) {
+    rebuild();
+  }
+  else {
+    updateBounds();
+    sortAxis(x_ends_, true);
+    sortAxis(y_ends_, false);
+    notifyContacts();
+  }
+  for (auto& contact : contacts_) {
+    separateBodies(*contact.first, *contact.second, world);
+  }
+}
+
+void SweepAndPruneInteractionSystem::rebuild() {
+  needs_rebuild_ = false;
+
+  auto by_bodies = [](const Contact& a, const Contact& b) {
+    return std::tie(a.first, a.second) < std::tie(b.first, b.second);
+  };
+  // Body indices change, so the old pairs are compared with the new ones by body.
+  auto previous = std::move(contacts_);
+  for (auto& contact : previous) {
+    if (contact.second < contact.first) {
+      std::swap(contact.first, contact.second);
+    }
+  }
+  std::ranges::sort(previous, by_bodies);
+
+  updateBounds();
+  x_ends_.clear();
+  y_ends_.clear();
+  for (uint32_t body = 0; body < bounds_.size(); ++body) {
+    auto& bounds = bounds_[body];
+    x_ends_.push_back({2 * bounds.x_min, body});
+    x_ends_.push_back({2 * bounds.x_max + 1, body});
+    y_ends_.push_back({2 * bounds.y_min, body});
+    y_ends_.push_back({2 * bounds.y_max + 1, body});
+  }
+  auto by_key = [](const Endpoint& a, const Endpoint& b) { return a.key < b.key; };
+  std::ranges::sort(x_ends_, by_key);
+  std::ranges::sort(y_ends_, by_key);
+
+  // Sweep along x, testing each body against those whose x range it starts within.
+  contacts_.clear();
+  pair_keys_.clear();
+  pair_indices_.clear();
+  std::vector<uint32_t> active;
+  for (auto& end : x_ends_) {
+    if (end.IsUpper()) {
+      auto it = std::ranges::find(active, end.body);
+      *it     = active.back();
+      active.pop_back();
+      continue;
+    }
+    for (auto other : active) {
+      if (overlaps(end.body, other)) {
+        addPair(end.body, other);
+      }
+    }
+    active.push_back(end.body);
+  }
+  touched_.clear();
+  touched_order_.clear();
+
+  std::vector<Contact> current;
+  for (auto contact : contacts_) {
+    if (contact.second < contact.first) {
+      std::swap(contact.first, contact.second);
+    }
+    current.push_back(contact);
+  }
+  std::ranges::sort(current, by_bodies);
+  std::vector<Contact> changed;
+  std::ranges::set_difference(current, previous, std::back_inserter(changed), by_bodies);
+  for (auto& contact : changed) {
+    beginContact(contact);
+  }
+  changed.clear();
+  std::ranges::set_difference(previous, current, std::back_inserter(changed), by_bodies);
+  for (auto& contact : changed) {
+    endContact(contact);
+  }
+}
+
+void SweepAndPruneInteractionSystem::updateBounds() {
+  bounds_.resize(members_.size());
+  for (std::size_t i = 0; i < members_.size(); ++i) {
+    auto* body    = members_[i];
+    auto position = body->GetPosition();
+    bounds_[i]    = {position.x,
+                     position.x + std::max(1ll, static_cast<long long>(body->GetWidth())) - 1,
+                     position.y,
+                     position.y + std::max(1ll, static_cast<long long>(body->GetHeight())) - 1};
+  }
+}
+
+void SweepAndPruneInteractionSystem::sortAxis(std::vector<Endpoint>& axis, bool is_x) {
+  for (auto& end : axis) {
+    auto& bounds = bounds_[end.body];
+    if (is_x) {
+      end.key = end.IsUpper() ? 2 * bounds.x_max + 1 : 2 * bounds.x_min;
+    }
+    else {
+      end.key = end.IsUpper() ? 2 * bounds.y_max + 1 : 2 * bounds.y_min;
+    }
+  }
+
+  for (std::size_t i = 1; i < axis.size(); ++i) {
+    for (auto j = i; 0 < j && axis[j].key < axis[j - 1].key; --j) {
+      auto &left = axis[j - 1], &right = axis[j];
+      // The right end moves below the left end.
+      if (!right.IsUpper() && left.IsUpper()) {
+        // A lower end passed an upper end, so the ranges now overlap along this axis.
+        if (overlaps(right.body, left.body)) {
+          addPair(right.body, left.body);
+        }
+      }
+      else if (right.IsUpper() && !left.IsUpper()) {
+        // An upper end passed a lower end, so the ranges are now apart.
+        removePair(right.body, left.body);
+      }
+      std::swap(left, right);
+    }
+  }
+}
+
+void SweepAndPruneInteractionSystem::addPair(uint32_t a, uint32_t b) {
+  auto key = pairKey(a, b);
+  if (pair_indices_.contains(key)) {
+    return;
+  }
+  touch(key);
+  pair_indices_.emplace(key, contacts_.size());
+  pair_keys_.push_back(key);
+  contacts_.push_back({members_[std::min(a, b)], members_[std::max(a, b)]});
+}
+
+void SweepAndPruneInteractionSystem::removePair(uint32_t a, uint32_t b) {
+  auto key = pairKey(a, b);
+  auto it  = pair_indices_.find(key);
+  if (it == pair_indices_.end()) {
+    return;
+  }
+  touch(key);
+  // Move the last pair into the removed pair's place.
+  auto index = it->second;
+  pair_indices_.erase(it);
+  if (index + 1 != contacts_.size()) {
+    contacts_[index]                    = contacts_.back();
+    pair_keys_[index]                   = pair_keys_.back();
+    pair_indices_.at(pair_keys_[index]) = index;
+  }
+  contacts_.pop_back();
+  pair_keys_.pop_back();
+}
+
+void SweepAndPruneInteractionSystem::touch(uint64_t key) {
+  if (touched_.emplace(key, pair_indices_.contains(key)).second) {
+    touched_order_.push_back(key);
+  }
+}
+
+void SweepAndPruneInteractionSystem::notifyContacts() {
+  for (auto key : touched_order_) {
+    const bool existed = touched_.at(key), exists = pair_indices_.contains(key);
+    if (existed == exists) {
+      continue;
+    }
+    Contact contact {members_[key >> 32], members_[key & 0xFFFFFFFFull]};
+    if (exists) {
+      beginContact(contact);
+    }
+    else {
+      endContact(contact);
+    }
+  }
+  touched_.clear();
+  touched_order_.clear();
+}
+
+}  // namespace pixelengine::physics
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "pixelengine/physics/InteractionSystem.h"
+
+namespace pixelengine::physics {
+
+//! \brief An interaction system that keeps its bodies from passing through one another, finding overlapping bodies
+//!        by sweep and prune.
+//!
+//! The ends of the bodies' boxes are kept sorted along both axes. Bodies move little from one update to the next,
+//! so re-sorting with insertion sort is close to linear, and every swap of two ends tells whether a pair of bodies
+//! started or stopped overlapping. The overlapping pairs are kept from update to update, and the bodies are notified
+//! when a pair is added or removed. Overlapping bodies are then pushed apart.
+//!
+//! Adding or removing members re-sorts everything and finds the pairs from scratch.
+class SweepAndPruneInteractionSystem : public InteractionSystem {
+public:
+  [[nodiscard]] std::span<const Contact> GetContacts() const override { return contacts_; }
+
+  [[nodiscard]] std::size_t GetNumMembers() const { return members_.size(); }
+
+private:
+  //! \brief A body's box in pixels, all bounds inclusive.
+  struct BodyBounds {
+    long long x_min, x_max, y_min, y_max;
+  };
+
+  //! \brief One end of a body's box along an axis.
+  struct Endpoint {
+    //! \brief Twice the coordinate, plus one for the upper end, so that a lower end sorts before an upper end at
+    //!        the same coordinate, and boxes that share a pixel overlap.
+    long long key;
+    uint32_t body;
+
+    [[nodiscard]] bool IsUpper() const { return (key & 1) != 0; }
+  };
+
+  void removeQueuedMembers() override;
+  void addQueuedMembers() override;
+
+  void computeInteractions(float dt, const world::World* world) override;
+
+  //! \brief Sort the ends from scratch and find every overlapping pair.
+  void rebuild();
+
+  void updateBounds();
+
+  //! \brief Insertion sort the ends along one axis, adding and removing pairs as their ends pass each other.
+  void sortAxis(std::vector<Endpoint>& axis, bool is_x);
+
+  [[nodiscard]] bool overlaps(uint32_t a, uint32_t b) const {
+    auto &first = bounds_[a], &second = bounds_[b];
+    return first.x_min <= second.x_max && second.x_min <= first.x_max && first.y_min <= second.y_max
+        && second.y_min <= first.y_max;
+  }
+
+  [[nodiscard]] static uint64_t pairKey(uint32_t a, uint32_t b) {
+    return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+  }
+
+  void addPair(uint32_t a, uint32_t b);
+  void removePair(uint32_t a, uint32_t b);
+
+  //! \brief Remember whether the pair existed before it is first changed during an update.
+  void touch(uint64_t key);
+
+  //! \brief Notify the bodies of pairs that were added or removed during the update.
+  void notifyContacts();
+
+  std::vector<PhysicsBody*> members_;
+  std::vector<BodyBounds> bounds_;
+  std::vector<Endpoint> x_ends_, y_ends_;
+
+  bool needs_rebuild_ = false;
+
+  //! \brief The overlapping pairs, and the key of each pair.
+  std::vector<Contact> contacts_;
+  std::vector<uint64_t> pair_keys_;
+  //! \brief The index of each pair in the contacts.
+  std::unordered_map<uint64_t, std::size_t> pair_indices_;
+
+  //! \brief The pairs changed during the current update, whether each existed before, and the order they changed in.
+  std::unordered_map<uint64_t, bool> touched_;
+  std::vector<uint64_t> touched_order_;
+};
+
+}  // namespace pixelengine::physics
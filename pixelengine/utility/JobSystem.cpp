@@ -0,0 +1,295 @@
+#include "pixelengine/utility/JobSystem.h"
+// Other files.
+#include <exception>
+
+#include "pixelengine/utility/Contracts.h"
+
+namespace pixelengine::utility {
+
+namespace {
+
+//! \brief The job system the calling thread is a worker of, if any, and its index in it.
+thread_local const JobSystem* current_system = nullptr;
+thread_local std::size_t current_worker      = 0;
+
+//! \brief How many times an idle worker looks for a job before it goes to sleep.
+constexpr int spins_before_sleeping = 64;
+
+}  // namespace
+
+JobSystem::JobSystem(std::size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  queues_.reserve(num_threads);
+  for (std::size_t i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  threads_.reserve(num_threads);
+  for (std::size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock(sleep_mutex_);
+    is_stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void JobSystem::Schedule(Job job) {
+  // Counted before it is queued, so the count is never less than the number of queued jobs.
+  ++num_queued_;
+  if (current_system == this) {
+    auto& queue = *queues_[current_worker];
+    std::lock_guard lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  else {
+    std::lock_guard lock(shared_mutex_);
+    shared_jobs_.push_back(std::move(job));
+  }
+  // Only take the lock to wake a worker if one is asleep. A worker counts itself as sleeping before it checks for
+  // jobs one last time, so either it sees this job, or this sees it sleeping.
+  if (0 < num_sleeping_) {
+    std::lock_guard lock(sleep_mutex_);
+    wake_.notify_one();
+  }
+}
+
+void JobSystem::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func) {
+  if (count == 0) {
+    return;
+  }
+  // Helpers (and the calling thread) claim indices until there are none left.
+  std::atomic<std::size_t> next_index {0};
+  std::atomic<std::size_t> num_finished {0};
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  auto run = [&] {
+    try {
+      for (auto i = next_index++; i < count; i = next_index++) {
+        func(i);
+      }
+    }
+    catch (...) {
+      std::lock_guard lock(exception_mutex);
+      exception = std::current_exception();
+      // Stop handing out indices.
+      next_index = count;
+    }
+  };
+
+  const auto num_helpers = std::min(count, threads_.size()) - 1;
+  for (std::size_t i = 0; i < num_helpers; ++i) {
+    Schedule([&] {
+      run();
+      ++num_finished;
+    });
+  }
+  run();
+  // The helpers refer to this stack frame, so all of them must finish, even if there was nothing left for them.
+  WaitUntil([&] { return num_finished == num_helpers; });
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void JobSystem::ParallelForTiles(std::size_t width,
+                                 std::size_t height,
+                                 std::size_t tile_size,
+                                 const std::function<void(const TileRange&)>& func) {
+  PIXEL_REQUIRE(0 < tile_size, "tile size must be positive");
+  const auto tiles_x = (width + tile_size - 1) / tile_size;
+  const auto tiles_y = (height + tile_size - 1) / tile_size;
+  ParallelFor(tiles_x * tiles_y, [&](std::size_t i) {
+    const auto x = (i % tiles_x) * tile_size;
+    const auto y = (i / tiles_x) * tile_size;
+    func(TileRange {x, std::min(x + tile_size, width), y, std::min(y + tile_size, height)});
+  });
+}
+
+void JobSystem::WaitUntil(const std::function<bool()>& is_done) {
+  while (!is_done()) {
+    if (!tryRunJob()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+std::size_t JobSystem::RunMainThreadTasks() {
+  std::deque<Job> jobs;
+  {
+    std::lock_guard lock(main_thread_mutex_);
+    jobs.swap(main_thread_jobs_);
+  }
+  for (auto& job : jobs) {
+    job();
+  }
+  return jobs.size();
+}
+
+JobSystem& JobSystem::Global() {
+  static JobSystem job_system;
+  return job_system;
+}
+
+void JobSystem::workerLoop(std::size_t index) {
+  current_system = this;
+  current_worker = index;
+  while (true) {
+    bool found_job = false;
+    for (int spin = 0; spin < spins_before_sleeping && !found_job; ++spin) {
+      found_job = tryRunJob();
+      if (!found_job) {
+        std::this_thread::yield();
+      }
+    }
+    if (found_job) {
+      continue;
+    }
+
+    std::unique_lock lock(sleep_mutex_);
+    ++num_sleeping_;
+    wake_.wait(lock, [this] { return is_stopping_ || 0 < num_queued_; });
+    --num_sleeping_;
+    if (is_stopping_ && num_queued_ == 0) {
+      return;  // Stopping, and nothing is left to do.
+    }
+  }
+}
+
+bool JobSystem::tryTakeJob(Job& job) {
+  auto take = [&](std::mutex& mutex, std::deque<Job>& jobs, bool from_back) {
+    std::lock_guard lock(mutex);
+    if (jobs.empty()) {
+      return false;
+    }
+    if (from_back) {
+      job = std::move(jobs.back());
+      jobs.pop_back();
+    }
+    else {
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    --num_queued_;
+    return true;
+  };
+
+  if (num_queued_ == 0) {
+    return false;
+  }
+  const bool is_worker = current_system == this;
+  if (is_worker && take(queues_[current_worker]->mutex, queues_[current_worker]->jobs, true)) {
+    return true;
+  }
+  if (take(shared_mutex_, shared_jobs_, false)) {
+    return true;
+  }
+  // Steal, starting from the next worker over, so thieves spread out.
+  const auto start = is_worker ? current_worker + 1 : 0;
+  for (std::size_t i = 0; i < queues_.size(); ++i) {
+    auto& queue = *queues_[(start + i) % queues_.size()];
+    if (take(queue.mutex, queue.jobs, false)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JobSystem::tryRunJob() {
+  Job job;
+  if (!tryTakeJob(job)) {
+    return false;
+  }
+  job();
+  return true;
+}
+
+TaskGraph::TaskId TaskGraph::Add(std::function<void()> func) {
+  tasks_.push_back({std::move(func), {}, 0});
+  return tasks_.size() - 1;
+}
+
+void TaskGraph::Precede(TaskId before, TaskId after) {
+  PIXEL_REQUIRE(before < tasks_.size() && after < tasks_.size(), "no such task");
+  tasks_[before].successors.push_back(after);
+  ++tasks_[after].num_dependencies;
+}
+
+void TaskGraph::Run(JobSystem& jobs) {
+  PIXEL_REQUIRE(isAcyclic(), "the dependencies of a task graph cannot form a cycle");
+  std::vector<std::atomic<std::size_t>> remaining(tasks_.size());
+  for (std::size_t i = 0; i < tasks_.size(); ++i) {
+    remaining[i] = tasks_[i].num_dependencies;
+  }
+  std::atomic<std::size_t> num_finished {0};
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  std::atomic<bool> has_failed {false};
+
+  std::function<void(TaskId)> schedule = [&](TaskId id) {
+    jobs.Schedule([&, id] {
+      // Once a task has thrown, the rest are skipped, but still release their successors, so every task finishes.
+      if (!has_failed) {
+        try {
+          tasks_[id].func();
+        }
+        catch (...) {
+          std::lock_guard lock(exception_mutex);
+          if (!exception) {
+            exception = std::current_exception();
+          }
+          has_failed = true;
+        }
+      }
+      for (auto successor : tasks_[id].successors) {
+        if (--remaining[successor] == 0) {
+          schedule(successor);
+        }
+      }
+      ++num_finished;
+    });
+  };
+  for (std::size_t i = 0; i < tasks_.size(); ++i) {
+    if (tasks_[i].num_dependencies == 0) {
+      schedule(i);
+    }
+  }
+  jobs.WaitUntil([&] { return num_finished == tasks_.size(); });
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+bool TaskGraph::isAcyclic() const {
+  // Kahn's algorithm: repeatedly remove tasks with no remaining dependencies. Tasks on a cycle are never removed.
+  std::vector<std::size_t> remaining(tasks_.size());
+  std::vector<TaskId> ready;
+  for (std::size_t i = 0; i < tasks_.size(); ++i) {
+    remaining[i] = tasks_[i].num_dependencies;
+    if (remaining[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  std::size_t num_removed = 0;
+  while (!ready.empty()) {
+    auto id = ready.back();
+    ready.pop_back();
+    ++num_removed;
+    for (auto successor : tasks_[id].successors) {
+      if (--remaining[successor] == 0) {
+        ready.push_back(successor);
+      }
+    }
+  }
+  return num_removed == tasks_.size();
+}
+
+}  // namespace pixelengine::utility
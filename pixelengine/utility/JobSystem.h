@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pixelengine::utility {
+
+//! \brief A rectangle of tiles, [x_begin, x_end) by [y_begin, y_end).
+struct TileRange {
+  std::size_t x_begin, x_end;
+  std::size_t y_begin, y_end;
+};
+
+//! \brief The engine's shared scheduler. Every worker thread has its own queue of jobs, running the newest job it
+//!        queued first, and idle workers steal the oldest jobs from the other queues. Jobs submitted from outside
+//!        the workers go into a shared queue.
+//!
+//! A thread that waits on the job system (ParallelFor, TaskGraph::Run, WaitUntil) runs queued jobs while it waits, so
+//! jobs can themselves wait on other jobs. Idle workers spin for a short while before going to sleep.
+//!
+//! Jobs that must run on the game's thread, e.g. because they touch the graphics device, can be submitted with
+//! SubmitToMainThread. They are run when the game calls RunMainThreadTasks.
+class JobSystem {
+public:
+  using Job = std::function<void()>;
+
+  //! \brief Create a job system with the given number of worker threads. Zero means one per hardware thread.
+  explicit JobSystem(std::size_t num_threads = 0);
+
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  //! \brief Finishes all queued jobs, then joins the workers.
+  ~JobSystem();
+
+  //! \brief Queue a job, without a way to wait on it.
+  void Schedule(Job job);
+
+  //! \brief Queue a job to run on a worker thread, returning a future for its result.
+  template<typename Func_t>
+  auto Submit(Func_t&& func) -> std::future<std::invoke_result_t<Func_t>> {
+    using result_t = std::invoke_result_t<Func_t>;
+    auto task      = std::make_shared<std::packaged_task<result_t()>>(std::forward<Func_t>(func));
+    auto future    = task->get_future();
+    Schedule([task] { (*task)(); });
+    return future;
+  }
+
+  //! \brief Call `func(i)` for every i in [0, count), spread across the workers, and wait for all of them. The
+  //!        calling thread helps with the work. Can be called from within a job.
+  void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func);
+
+  //! \brief Split a width by height rectangle into tiles of (at most) tile_size by tile_size, and call `func` for
+  //!        every tile, in parallel.
+  void ParallelForTiles(std::size_t width,
+                        std::size_t height,
+                        std::size_t tile_size,
+                        const std::function<void(const TileRange&)>& func);
+
+  //! \brief Run queued jobs on the calling thread until `is_done` returns true.
+  void WaitUntil(const std::function<bool()>& is_done);
+
+  //! \brief Queue a job to run on the main thread, the next time it calls RunMainThreadTasks.
+  template<typename Func_t>
+  auto SubmitToMainThread(Func_t&& func) -> std::future<std::invoke_result_t<Func_t>> {
+    using result_t = std::invoke_result_t<Func_t>;
+    auto task      = std::make_shared<std::packaged_task<result_t()>>(std::forward<Func_t>(func));
+    auto future    = task->get_future();
+    {
+      std::lock_guard lock(main_thread_mutex_);
+      main_thread_jobs_.emplace_back([task] { (*task)(); });
+    }
+    return future;
+  }
+
+  //! \brief Run the jobs that were submitted to the main thread. Returns how many were run.
+  std::size_t RunMainThreadTasks();
+
+  [[nodiscard]] std::size_t GetNumThreads() const { return threads_.size(); }
+
+  //! \brief Get the job system shared by the whole engine, created on first use.
+  static JobSystem& Global();
+
+private:
+  //! \brief A worker's queue. The worker pushes and pops at the back, thieves take from the front.
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void workerLoop(std::size_t index);
+
+  //! \brief Take a job for the calling thread: its own newest job if it is a worker, else the oldest shared job, else
+  //!        one stolen from another worker.
+  bool tryTakeJob(Job& job);
+
+  //! \brief Take and run one job, if there is one.
+  bool tryRunJob();
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  //! \brief Jobs scheduled from threads that are not workers of this system.
+  std::mutex shared_mutex_;
+  std::deque<Job> shared_jobs_;
+
+  //! \brief How many jobs are queued, in all queues. Sleeping workers wait for this to be non-zero.
+  std::atomic<std::size_t> num_queued_ {0};
+  std::atomic<std::size_t> num_sleeping_ {0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool is_stopping_ = false;
+
+  std::mutex main_thread_mutex_;
+  std::deque<Job> main_thread_jobs_;
+};
+
+//! \brief A set of tasks, some of which must wait for others to finish, run on a job system. Each task is run as soon
+//!        as everything it depends on is done.
+class TaskGraph {
+public:
+  using TaskId = std::size_t;
+
+  //! \brief Add a task, returning its id.
+  TaskId Add(std::function<void()> func);
+
+  //! \brief Make the task `after` wait for the task `before` to finish.
+  void Precede(TaskId before, TaskId after);
+
+  //! \brief Run every task, and wait for all of them. The graph can be run again. If a task throws, the tasks that
+  //!        have not started yet are skipped, and the first exception is rethrown once the rest have finished.
+  void Run(JobSystem& jobs);
+
+  [[nodiscard]] std::size_t GetNumTasks() const { return tasks_.size(); }
+
+private:
+  struct Task {
+    std::function<void()> func;
+    std::vector<TaskId> successors;
+    std::size_t num_dependencies {};
+  };
+
+  //! \brief Check that the dependencies do not form a cycle, which could never run.
+  [[nodiscard]] bool isAcyclic() const;
+
+  std::vector<Task> tasks_;
+};
+
+}  // namespace pixelengine::utility
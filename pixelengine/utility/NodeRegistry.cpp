@@ -0,0 +1,125 @@
+#include "pixelengine/utility/NodeRegistry.h"
+// Other files.
+#include "pixelengine/utility/Contracts.h"
+
+namespace pixelengine {
+
+NodeHandle NodeRegistry::Register(Node* node, std::string_view name) {
+  PIXEL_ASSERT(node, "Cannot register a null node.");
+  std::lock_guard lock(mutex_);
+  std::uint32_t index;
+  if (free_slots_.empty()) {
+    index = static_cast<std::uint32_t>(slots_.size());
+    slots_.emplace_back();
+  }
+  else {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  auto& slot  = slots_[index];
+  slot.node   = node;
+  slot.parent = no_parent_;
+  slot.name   = name;
+  addName(index);
+  return {index, slot.generation};
+}
+
+void NodeRegistry::Unregister(NodeHandle handle) {
+  std::lock_guard lock(mutex_);
+  if (!resolve(handle)) {
+    return;
+  }
+  removeName(handle.index);
+  auto& slot = slots_[handle.index];
+  slot.node  = nullptr;
+  ++slot.generation;
+  free_slots_.push_back(handle.index);
+}
+
+void NodeRegistry::Rename(NodeHandle handle, std::string_view name) {
+  std::lock_guard lock(mutex_);
+  if (!resolve(handle) || slots_[handle.index].name == name) {
+    return;
+  }
+  removeName(handle.index);
+  slots_[handle.index].name = name;
+  addName(handle.index);
+}
+
+void NodeRegistry::SetParent(NodeHandle handle, NodeHandle parent) {
+  std::lock_guard lock(mutex_);
+  if (resolve(handle)) {
+    slots_[handle.index].parent = resolve(parent) ? parent.index : no_parent_;
+  }
+}
+
+NodeHandle NodeRegistry::FindByName(std::string_view name) const {
+  std::lock_guard lock(mutex_);
+  auto it = by_name_.find(name);
+  if (it == by_name_.end()) {
+    return {};
+  }
+  auto index = it->second.front();
+  return {index, slots_[index].generation};
+}
+
+NodeHandle NodeRegistry::FindByPath(std::string_view path) const {
+  std::lock_guard lock(mutex_);
+  auto split = path.rfind('/');
+  auto it    = by_name_.find(split == std::string_view::npos ? path : path.substr(split + 1));
+  if (it == by_name_.end()) {
+    return {};
+  }
+  // Only nodes with the last name in the path can match. Check that each one's ancestors have the rest of the names.
+  for (auto index : it->second) {
+    auto rest   = path;
+    auto parent = index;
+    bool match  = true;
+    while (match) {
+      auto end = rest.rfind('/');
+      if (end == std::string_view::npos) {
+        // The first name in the path must be the root of the tree.
+        match = slots_[parent].parent == no_parent_;
+        break;
+      }
+      rest   = rest.substr(0, end);
+      parent = slots_[parent].parent;
+      // If there is no '/' left, rfind gives npos, and npos + 1 is the start of the string.
+      match = parent != no_parent_ && slots_[parent].name == rest.substr(rest.rfind('/') + 1);
+    }
+    if (match) {
+      return {index, slots_[index].generation};
+    }
+  }
+  return {};
+}
+
+NodeRegistry& NodeRegistry::Global() {
+  static NodeRegistry registry;
+  return registry;
+}
+
+void NodeRegistry::addName(std::uint32_t index) {
+  auto& slot = slots_[index];
+  auto it    = by_name_.find(std::string_view(slot.name));
+  if (it == by_name_.end()) {
+    it = by_name_.emplace(slot.name, std::vector<std::uint32_t> {}).first;
+  }
+  slot.position_in_name = it->second.size();
+  it->second.push_back(index);
+}
+
+void NodeRegistry::removeName(std::uint32_t index) {
+  auto& slot   = slots_[index];
+  auto it      = by_name_.find(std::string_view(slot.name));
+  auto& others = it->second;
+  // Swap the last slot with this name into this one's place.
+  others[slot.position_in_name]          = others.back();
+  slots_[others.back()].position_in_name = slot.position_in_name;
+  others.pop_back();
+  if (others.empty()) {
+    by_name_.erase(it);
+  }
+}
+
+}  // namespace pixelengine
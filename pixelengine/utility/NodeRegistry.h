@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace pixelengine {
+
+class Node;
+
+//! \brief A reference to a node that can be held past the node's lifetime. Once the node is destroyed, the handle
+//!        resolves to null instead of dangling, even if the node's slot is reused.
+struct NodeHandle {
+  std::uint32_t index      = std::numeric_limits<std::uint32_t>::max();
+  std::uint32_t generation = 0;
+
+  friend bool operator==(const NodeHandle&, const NodeHandle&) = default;
+};
+
+//! \brief Keeps track of every live node, so nodes can be found in constant time from a handle, or from their name,
+//!        without walking the tree.
+//!
+//! Nodes register themselves when they are created and unregister when they are destroyed. Each slot has a
+//! generation that is bumped when the slot is freed, so stale handles never resolve to a different node. The registry
+//! is locked, since nodes may be created and destroyed by subtrees running in parallel.
+class NodeRegistry {
+public:
+  //! \brief Add a node to the registry, and get a handle to it.
+  NodeHandle Register(Node* node, std::string_view name);
+
+  //! \brief Remove a node from the registry. Its handles will no longer resolve.
+  void Unregister(NodeHandle handle);
+
+  //! \brief Update the name a node can be found by.
+  void Rename(NodeHandle handle, std::string_view name);
+
+  //! \brief Record the parent of a node, so it can be found by its path.
+  void SetParent(NodeHandle handle, NodeHandle parent);
+
+  //! \brief Get the node a handle refers to, or null if the node no longer exists.
+  [[nodiscard]] Node* Resolve(NodeHandle handle) const {
+    std::lock_guard lock(mutex_);
+    return resolve(handle);
+  }
+
+  [[nodiscard]] bool IsAlive(NodeHandle handle) const { return Resolve(handle) != nullptr; }
+
+  //! \brief Find a node with the given name, or a null handle if there is none. If several nodes have the name, any
+  //!        one of them may be returned.
+  [[nodiscard]] NodeHandle FindByName(std::string_view name) const;
+
+  //! \brief Find the node at a path of names separated by '/', starting from the root of its tree, e.g.
+  //!        "GameScene/Player". Returns a null handle if there is no such node.
+  [[nodiscard]] NodeHandle FindByPath(std::string_view path) const;
+
+  [[nodiscard]] std::size_t GetNumNodes() const {
+    std::lock_guard lock(mutex_);
+    return slots_.size() - free_slots_.size();
+  }
+
+  //! \brief Get the registry that all nodes register with, created on first use.
+  static NodeRegistry& Global();
+
+private:
+  static constexpr std::uint32_t no_parent_ = std::numeric_limits<std::uint32_t>::max();
+
+  struct Slot {
+    Node* node {};
+    //! \brief Starts at 1, so a default constructed handle never resolves.
+    std::uint32_t generation = 1;
+    std::uint32_t parent     = no_parent_;
+    std::string name;
+    //! \brief Where the slot is in the list of slots with the same name, so it can be removed without a search.
+    std::size_t position_in_name {};
+  };
+
+  //! \brief Hash that lets the name index be searched with a string_view, without making a string.
+  struct NameHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view name) const { return std::hash<std::string_view> {}(name); }
+  };
+
+  [[nodiscard]] Node* resolve(NodeHandle handle) const {
+    if (handle.index < slots_.size() && slots_[handle.index].generation == handle.generation) {
+      return slots_[handle.index].node;
+    }
+    return nullptr;
+  }
+
+  void addName(std::uint32_t index);
+  void removeName(std::uint32_t index);
+
+  mutable std::mutex mutex_;
+
+  std::vector<Slot> slots_;
+  std::vector<std::uint32_t> free_slots_;
+
+  //! \brief The slots of the nodes with each name.
+  std::unordered_map<std::string, std::vector<std::uint32_t>, NameHash, std::equal_to<>> by_name_;
+};
+
+}  // namespace pixelengine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace pixelengine::math {
+
+//! \brief Hash a seed and a pair of integer coordinates into 64 well mixed bits. The same inputs always give
+//!        the same result, on every platform.
+constexpr uint64_t HashCoordinates(uint64_t seed, long long x, long long y) {
+  // Combine, then apply the SplitMix64 finalizer.
+  uint64_t h = seed ^ (static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull)
+             ^ (static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4Full);
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ull;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBull;
+  h ^= h >> 31;
+  return h;
+}
+
+//! \brief Map a hash to a float uniformly distributed in [0, 1).
+constexpr float HashToUnitFloat(uint64_t hash) {
+  return static_cast<float>(hash >> 40) / static_cast<float>(1ull << 24);
+}
+
+//! \brief Random value in [0, 1) that is fixed for a given seed and lattice point.
+constexpr float LatticeValue(uint64_t seed, long long x, long long y) {
+  return HashToUnitFloat(HashCoordinates(seed, x, y));
+}
+
+//! \brief Smoothly interpolated value noise, in [0, 1). The noise varies on a length scale of one unit.
+inline float ValueNoise(uint64_t seed, float x, float y) {
+  auto x0 = static_cast<long long>(std::floor(x)), y0 = static_cast<long long>(std::floor(y));
+  auto fx = x - static_cast<float>(x0), fy = y - static_cast<float>(y0);
+  // Smoothstep fade, so the noise has no visible lattice creases.
+  auto u = fx * fx * (3.f - 2.f * fx), v = fy * fy * (3.f - 2.f * fy);
+
+  auto bottom = std::lerp(LatticeValue(seed, x0, y0), LatticeValue(seed, x0 + 1, y0), u);
+  auto top    = std::lerp(LatticeValue(seed, x0, y0 + 1), LatticeValue(seed, x0 + 1, y0 + 1), u);
+  return std::lerp(bottom, top, v);
+}
+
+//! \brief Sum of `octaves` layers of value noise, each at twice the frequency and half the amplitude of the
+//!        last, normalized to [0, 1).
+inline float FractalNoise(uint64_t seed, float x, float y, int octaves) {
+  float sum = 0.f, amplitude = 1.f, total_amplitude = 0.f;
+  for (int octave = 0; octave < octaves; ++octave) {
+    // Each octave gets its own seed, so the layers are uncorrelated.
+    sum += amplitude * ValueNoise(seed + static_cast<uint64_t>(octave) * 0x632BE59BD9B4E019ull, x, y);
+    total_amplitude += amplitude;
+    x *= 2.f;
+    y *= 2.f;
+    amplitude *= 0.5f;
+  }
+  return sum / total_amplitude;
+}
+
+}  // namespace pixelengine::math
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "pixelengine/utility/Contracts.h"
+#include "pixelengine/utility/NodeRegistry.h"
 
 
 namespace pixelengine {
@@ -13,6 +16,10 @@ namespace pixelengine {
 // Forward declaration of Node class.
 class Node;
 
+//! \brief A set of events, one per bit, after which a signal should be checked. Signals with no events are checked
+//!        every frame.
+using signal_events_t = std::uint32_t;
+
 template<typename... Args_t>
 using signal_emitter_t = std::optional<std::tuple<Args_t...>>;
 
@@ -23,6 +30,9 @@ using signal_check_t = std::function<signal_emitter_t<Args_t...>()>;
 
 
 //! \brief Signal represents events that other nodes (or things) can listen to.
+//!
+//! Listeners are held by their handles, so a node that is destroyed without disconnecting is skipped instead of
+//! called, and is dropped the next time a listener connects.
 template<typename... Args_t>
 class Signal {
 public:
@@ -30,20 +40,30 @@ public:
 
   using Callback = std::function<void(Args_t...)>;
 
-  void Connect(Node* node, Callback callback) {
+  template<typename node_t>
+  requires (std::is_base_of_v<Node, node_t>)
+  void Connect(node_t* node, Callback callback) {
     PIXEL_ASSERT(node, "Cannot connect signal to null node.");
-    listeners_.emplace_back(node, std::move(callback));
+    removeDeadListeners();
+    listeners_.emplace_back(node->GetHandle(), std::move(callback));
   }
 
   template<typename node_t>
   requires (std::is_base_of_v<Node, node_t>)
   void Connect(node_t* node, void (node_t::*callback)(Args_t...)) {
     PIXEL_ASSERT(node, "Cannot connect signal to null node.");
-    listeners_.emplace_back(node, Callback(std::bind_front(callback, node)));
+    removeDeadListeners();
+    listeners_.emplace_back(node->GetHandle(), Callback(std::bind_front(callback, node)));
+  }
+
+  void Disconnect(NodeHandle handle) {
+    std::erase_if(listeners_, [handle](const auto& pair) { return pair.first == handle; });
   }
 
-  void Disconnect(Node* node) {
-    std::ranges::remove_if(listeners_, [node](const auto& pair) { return pair.first == node; });
+  template<typename node_t>
+  requires (std::is_base_of_v<Node, node_t>)
+  void Disconnect(node_t* node) {
+    Disconnect(node->GetHandle());
   }
 
   void Clear() { listeners_.clear(); }
@@ -54,22 +74,40 @@ public:
 private:
   //! \brief Emit the signal to all listeners.
   void emit(Args_t... args) const {
-    for (const auto& [node, callback] : listeners_) {
-      callback(args...);
+    auto& registry = NodeRegistry::Global();
+    for (const auto& [handle, callback] : listeners_) {
+      if (registry.IsAlive(handle)) {
+        callback(args...);
+      }
     }
   }
 
-  std::vector<std::pair<Node*, Callback>> listeners_;
+  void removeDeadListeners() {
+    std::erase_if(listeners_, [](const auto& pair) { return !NodeRegistry::Global().IsAlive(pair.first); });
+  }
+
+  std::vector<std::pair<NodeHandle, Callback>> listeners_;
 };
 
 //! \brief Class used to register a node's signals and how how to check them.
+//!
+//! An emitter can be subscribed to events, in which case it only needs to be checked on frames where one of those
+//! events happened, instead of every frame.
 class SignalEmitter {
 public:
   template<typename... Args_t>
-  SignalEmitter(Signal<Args_t...>* signal, signal_check_t<Args_t...> check);
+  SignalEmitter(Signal<Args_t...>* signal, signal_check_t<Args_t...> check, signal_events_t events = 0);
 
   void CheckSignal();
 
+  //! \brief Whether anything is listening to the signal. If not, there is no need to check it.
+  [[nodiscard]] bool HasListeners() const;
+
+  [[nodiscard]] signal_events_t GetEvents() const { return events_; }
+
+  //! \brief Whether the signal should be checked, given the events that happened this frame.
+  [[nodiscard]] bool IsDue(signal_events_t events) const { return events_ == 0 || (events_ & events) != 0; }
+
 private:
   class Impl;
 
@@ -77,12 +115,14 @@ private:
   class ImplT;
 
   std::unique_ptr<Impl> impl_;
+  signal_events_t events_;
 };
 
 class SignalEmitter::Impl {
 public:
-  virtual ~Impl()            = default;
-  virtual void checkSignal() = 0;
+  virtual ~Impl()                                  = default;
+  virtual void checkSignal()                       = 0;
+  [[nodiscard]] virtual bool hasListeners() const = 0;
 };
 
 template<typename... Args_t>
@@ -102,17 +142,24 @@ public:
     }
   }
 
+  [[nodiscard]] bool hasListeners() const override { return !signal_->Empty(); }
+
 private:
   const signal_t* signal_;
   check_t check_signal_;
 };
 
 template<typename... Args_t>
-SignalEmitter::SignalEmitter(Signal<Args_t...>* signal, signal_check_t<Args_t...> check)
-    : impl_(std::make_unique<ImplT<Args_t...>>(signal, std::move(check))) {}
+SignalEmitter::SignalEmitter(Signal<Args_t...>* signal, signal_check_t<Args_t...> check, signal_events_t events)
+    : impl_(std::make_unique<ImplT<Args_t...>>(signal, std::move(check)))
+    , events_(events) {}
 
 inline void SignalEmitter::CheckSignal() {
   impl_->checkSignal();
 }
 
+inline bool SignalEmitter::HasListeners() const {
+  return impl_->hasListeners();
+}
+
 }  // namespace pixelengine
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+namespace pixelengine::utility {
+
+//! \brief Hands values from one writer thread to one reader thread without locks. The writer fills one buffer while
+//!        the reader holds another, and the third holds the latest published value, so neither thread ever waits
+//!        for the other, and the reader never sees a half-written value.
+//!
+//! The reader always gets the latest published value. Values published in between its reads are skipped.
+template<typename T>
+class TripleBuffer {
+public:
+  //! \brief Get the buffer to fill with the next value. Writer thread only. It holds whatever value was last written
+  //!        to it, so its storage can be reused.
+  [[nodiscard]] T& GetWriteBuffer() { return buffers_[write_]; }
+
+  //! \brief Make the write buffer the latest value, and get a new write buffer. Writer thread only.
+  void Publish() {
+    auto previous = middle_.exchange(write_ | fresh_bit_, std::memory_order_acq_rel);
+    write_        = previous & index_mask_;
+  }
+
+  //! \brief Get the latest published value, or null if nothing was ever published. Reader thread only. The value
+  //!        stays valid, and unchanged, until the next call to Acquire.
+  [[nodiscard]] const T* Acquire() {
+    if (middle_.load(std::memory_order_relaxed) & fresh_bit_) {
+      auto previous = middle_.exchange(read_, std::memory_order_acq_rel);
+      read_         = previous & index_mask_;
+      has_read_     = true;
+    }
+    return has_read_ ? &buffers_[read_] : nullptr;
+  }
+
+private:
+  static constexpr std::uint8_t index_mask_ = 0b011;
+  //! \brief Set in the middle index when it holds a value the reader has not taken yet.
+  static constexpr std::uint8_t fresh_bit_ = 0b100;
+
+  std::array<T, 3> buffers_ {};
+
+  //! \brief The buffer with the latest published value, and whether the reader has taken it.
+  std::atomic<std::uint8_t> middle_ {1};
+
+  // Each of these is only touched by one thread.
+
+  std::uint8_t write_ = 0;
+  std::uint8_t read_  = 2;
+  bool has_read_      = false;
+};
+
+}  // namespace pixelengine::utility
@@ -56,6 +56,21 @@ struct BoundingBox {
     y_max = std::max(y_max, other.y_max);
   }
 
+  //! \brief Get the part of this bounding box that also lies within the other bounding box.
+  [[nodiscard]] BoundingBox Intersection(const BoundingBox& other) const {
+    if (IsEmpty() || other.IsEmpty()) {
+      return {};
+    }
+    BoundingBox result {std::max(x_min, other.x_min),
+                        std::min(x_max, other.x_max),
+                        std::max(y_min, other.y_min),
+                        std::min(y_max, other.y_max)};
+    if (result.IsEmpty() || result.y_max < result.y_min) {
+      return {};
+    }
+    return result;
+  }
+
   void Expand(long long amount) {
     if (x_min <= x_max) {
       x_min -= amount;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pixelengine/world/BoundingBox.h"
+
+namespace pixelengine::world {
+
+//! \brief Keeps track of which parts of a (finite) world have changed, so systems that derive data from the
+//!        squares (lighting, navigation, etc.) only redo the work for the parts that changed.
+//!
+//! The world is divided into square chunks. Every change is given a new, increasing version number, which is
+//! recorded in each chunk the change touched. A system remembers the newest version it has seen, and anything in
+//! a chunk with a newer version has changed since then.
+class ChangeTracker {
+public:
+  ChangeTracker() = default;
+
+  ChangeTracker(std::size_t width, std::size_t height, long long chunk_size)
+      : width_(static_cast<long long>(width))
+      , height_(static_cast<long long>(height))
+      , chunk_size_(chunk_size)
+      , chunks_x_((width_ + chunk_size - 1) / chunk_size)
+      , chunks_y_((height_ + chunk_size - 1) / chunk_size)
+      , versions_(static_cast<std::size_t>(chunks_x_ * chunks_y_), 0) {}
+
+  //! \brief Record that the squares in the region changed.
+  void MarkChanged(const BoundingBox& region) {
+    auto [x_min, x_max, y_min, y_max] = BoundingBox(region).Clip(width_, height_);
+    if (x_max < x_min || y_max < y_min || region.IsEmpty()) {
+      return;
+    }
+    ++version_;
+    for (auto cy = y_min / chunk_size_; cy <= y_max / chunk_size_; ++cy) {
+      for (auto cx = x_min / chunk_size_; cx <= x_max / chunk_size_; ++cx) {
+        versions_[static_cast<std::size_t>(cy * chunks_x_ + cx)] = version_;
+      }
+    }
+  }
+
+  //! \brief Get the version of the most recent change anywhere in the world. Zero if nothing has changed.
+  [[nodiscard]] uint64_t GetVersion() const { return version_; }
+
+  //! \brief Get the version of the most recent change within a chunk.
+  [[nodiscard]] uint64_t GetChunkVersion(long long cx, long long cy) const {
+    return versions_[static_cast<std::size_t>(cy * chunks_x_ + cx)];
+  }
+
+  //! \brief Get the version of the most recent change in any chunk that overlaps the region.
+  [[nodiscard]] uint64_t GetVersion(const BoundingBox& region) const {
+    auto [x_min, x_max, y_min, y_max] = BoundingBox(region).Clip(width_, height_);
+    if (x_max < x_min || y_max < y_min || region.IsEmpty()) {
+      return 0;
+    }
+    uint64_t version = 0;
+    for (auto cy = y_min / chunk_size_; cy <= y_max / chunk_size_; ++cy) {
+      for (auto cx = x_min / chunk_size_; cx <= x_max / chunk_size_; ++cx) {
+        version = std::max(version, GetChunkVersion(cx, cy));
+      }
+    }
+    return version;
+  }
+
+  //! \brief Get the squares covered by a chunk.
+  [[nodiscard]] BoundingBox GetChunkBounds(long long cx, long long cy) const {
+    return {cx * chunk_size_,
+            std::min((cx + 1) * chunk_size_, width_) - 1,
+            cy * chunk_size_,
+            std::min((cy + 1) * chunk_size_, height_) - 1};
+  }
+
+  [[nodiscard]] long long GetChunkSize() const { return chunk_size_; }
+  [[nodiscard]] long long GetNumChunksX() const { return chunks_x_; }
+  [[nodiscard]] long long GetNumChunksY() const { return chunks_y_; }
+
+private:
+  long long width_ = 0, height_ = 0;
+  long long chunk_size_ = 32;
+  long long chunks_x_ = 0, chunks_y_ = 0;
+
+  uint64_t version_ = 0;
+
+  std::vector<uint64_t> versions_;
+};
+
+}  // namespace pixelengine::world
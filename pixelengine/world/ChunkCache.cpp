@@ -0,0 +1,151 @@
+#include "pixelengine/world/ChunkCache.h"
+// Other files.
+#include <fstream>
+#include <sstream>
+
+namespace pixelengine::world {
+
+namespace {
+
+//! \brief Identifies chunk files, and their format version.
+constexpr std::array<char, 4> chunk_magic {'P', 'X', 'C', '2'};
+
+//! \brief How a single square is stored on disk.
+struct StoredSquare {
+  uint16_t palette_id;
+  Color color;
+  uint8_t is_occupied;
+  uint8_t is_opaque;
+};
+
+struct ChunkHeader {
+  std::array<char, 4> magic;
+  uint32_t width;
+  uint32_t height;
+  uint32_t palette_size;
+  //! \brief The fingerprint of the generator that made the chunk.
+  uint64_t generator;
+};
+
+}  // namespace
+
+uint16_t SquarePalette::Register(const Material* material, const SquareBehavior* behavior) {
+  if (auto id = Find(material, behavior)) {
+    return *id;
+  }
+  entries_.emplace_back(material, behavior);
+  return static_cast<uint16_t>(entries_.size() - 1);
+}
+
+std::optional<uint16_t> SquarePalette::Find(const Material* material, const SquareBehavior* behavior) const {
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].first == material && entries_[i].second == behavior) {
+      return static_cast<uint16_t>(i);
+    }
+  }
+  return {};
+}
+
+ChunkCache::ChunkCache(std::filesystem::path directory, const SquarePalette* palette)
+    : directory_(std::move(directory))
+    , palette_(palette) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    LOG_SEV(Warning) << "Could not create chunk cache directory " << directory_ << ": " << error.message();
+  }
+}
+
+std::optional<Prefab> ChunkCache::Load(uint64_t seed,
+                                       uint64_t generator,
+                                       PVec2 chunk,
+                                       std::size_t width,
+                                       std::size_t height) const {
+  std::ifstream in(getPath(seed, generator, chunk), std::ios::binary);
+  if (!in) {
+    return {};
+  }
+
+  ChunkHeader header {};
+  in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!in || header.magic != chunk_magic || header.width != width || header.height != height
+      || header.palette_size != palette_->Size() || header.generator != generator)
+  {
+    // Stale or foreign file, the chunk will be regenerated (and the file replaced).
+    return {};
+  }
+
+  std::vector<StoredSquare> stored(width * height);
+  in.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(stored.size() * sizeof(StoredSquare)));
+  if (!in) {
+    return {};
+  }
+
+  Prefab prefab(width, height);
+  for (std::size_t y = 0; y < height; ++y) {
+    for (std::size_t x = 0; x < width; ++x) {
+      auto& entry = stored[y * width + x];
+      if (!entry.is_opaque) {
+        continue;
+      }
+      if (palette_->Size() <= entry.palette_id) {
+        return {};
+      }
+      auto [material, behavior] = palette_->Get(entry.palette_id);
+      prefab.SetSquare(x, y, Square(entry.is_occupied != 0, entry.color, material, behavior));
+    }
+  }
+  return prefab;
+}
+
+bool ChunkCache::Store(uint64_t seed, uint64_t generator, PVec2 chunk, const Prefab& prefab) const {
+  std::vector<StoredSquare> stored(prefab.GetWidth() * prefab.GetHeight());
+  for (std::size_t y = 0; y < prefab.GetHeight(); ++y) {
+    for (std::size_t x = 0; x < prefab.GetWidth(); ++x) {
+      auto& entry = stored[y * prefab.GetWidth() + x];
+      if (!prefab.IsOpaque(x, y)) {
+        entry = {};
+        continue;
+      }
+      auto& square = prefab.GetSquare(x, y);
+      auto id      = palette_->Find(square.material, square.behavior);
+      if (!id) {
+        LOG_SEV(Debug) << "Chunk " << chunk << " has a square that is not in the palette, not caching it.";
+        return false;
+      }
+      entry = {*id, square.color, static_cast<uint8_t>(square.is_occupied), 1};
+    }
+  }
+
+  ChunkHeader header {chunk_magic,
+                      static_cast<uint32_t>(prefab.GetWidth()),
+                      static_cast<uint32_t>(prefab.GetHeight()),
+                      static_cast<uint32_t>(palette_->Size()),
+                      generator};
+
+  // Write to a temporary file, then rename, so a reader never sees a partially written chunk.
+  auto path = getPath(seed, generator, chunk);
+  auto temporary_path = path;
+  temporary_path += ".tmp";
+  {
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(stored.data()),
+              static_cast<std::streamsize>(stored.size() * sizeof(StoredSquare)));
+    if (!out) {
+      LOG_SEV(Warning) << "Could not write chunk cache file " << temporary_path << ".";
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  return !error;
+}
+
+std::filesystem::path ChunkCache::getPath(uint64_t seed, uint64_t generator, PVec2 chunk) const {
+  std::ostringstream name;
+  name << std::hex << seed << "_" << generator << std::dec << "_" << chunk.x << "_" << chunk.y << ".chunk";
+  return directory_ / name.str();
+}
+
+}  // namespace pixelengine::world
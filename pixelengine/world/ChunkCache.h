@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+#include "pixelengine/world/Prefab.h"
+
+namespace pixelengine::world {
+
+//! \brief The set of (material, behavior) pairs that squares can have. Assigns each pair a small id, so squares
+//!        can be written to and read from disk.
+//!
+//! \note Pairs must be registered in the same order every run for ids to be stable.
+class SquarePalette {
+public:
+  //! \brief Register a pair, returning its id. Registering a pair twice returns the same id.
+  uint16_t Register(const Material* material, const SquareBehavior* behavior);
+
+  //! \brief Get the id of a pair, or nullopt if the pair was never registered.
+  [[nodiscard]] std::optional<uint16_t> Find(const Material* material, const SquareBehavior* behavior) const;
+
+  [[nodiscard]] const std::pair<const Material*, const SquareBehavior*>& Get(uint16_t id) const {
+    return entries_[id];
+  }
+
+  [[nodiscard]] std::size_t Size() const { return entries_.size(); }
+
+private:
+  std::vector<std::pair<const Material*, const SquareBehavior*>> entries_;
+};
+
+//! \brief Stores generated chunks on disk, keyed by the world seed, the generator's fingerprint, and the chunk
+//!        coordinates, so chunks that were generated before do not have to be generated again.
+//!
+//! Loading and storing different chunks from several threads at once is safe.
+class ChunkCache {
+public:
+  ChunkCache(std::filesystem::path directory, const SquarePalette* palette);
+
+  //! \brief Load a chunk, if it was cached by the same generator, with the same dimensions and palette.
+  [[nodiscard]] std::optional<Prefab> Load(uint64_t seed,
+                                           uint64_t generator,
+                                           PVec2 chunk,
+                                           std::size_t width,
+                                           std::size_t height) const;
+
+  //! \brief Store a chunk. Returns false if the chunk could not be stored, e.g. because it contains a square
+  //!        whose (material, behavior) pair is not in the palette.
+  bool Store(uint64_t seed, uint64_t generator, PVec2 chunk, const Prefab& prefab) const;
+
+private:
+  [[nodiscard]] std::filesystem::path getPath(uint64_t seed, uint64_t generator, PVec2 chunk) const;
+
+  std::filesystem::path directory_;
+
+  const SquarePalette* palette_;
+};
+
+}  // namespace pixelengine::world
@@ -0,0 +1,252 @@
+#include "pixelengine/world/DistanceField.h"
+// Other files.
+#include <limits>
+
+namespace pixelengine::world {
+
+namespace {
+
+constexpr float far_away = 1e20f;
+
+//! \brief The one dimensional squared distance transform of Felzenszwalb and Huttenlocher. Given f, computes
+//!        d[q] = min_p (q - p)^2 + f[p] in linear time, using the lower envelope of the parabolas rooted at each p.
+void distanceTransform(const float* f, float* d, long long n, long long stride, std::vector<long long>& v, std::vector<float>& z) {
+  v.resize(static_cast<std::size_t>(n));
+  z.resize(static_cast<std::size_t>(n + 1));
+  long long k = 0;
+  v[0]        = 0;
+  z[0]        = -far_away;
+  z[1]        = far_away;
+  auto at     = [&](long long i) { return f[i * stride]; };
+  for (long long q = 1; q < n; ++q) {
+    float s;
+    while (true) {
+      auto p = v[static_cast<std::size_t>(k)];
+      s      = ((at(q) + static_cast<float>(q * q)) - (at(p) + static_cast<float>(p * p))) / static_cast<float>(2 * (q - p));
+      if (s <= z[static_cast<std::size_t>(k)] && 0 < k) {
+        --k;
+        continue;
+      }
+      break;
+    }
+    ++k;
+    v[static_cast<std::size_t>(k)]     = q;
+    z[static_cast<std::size_t>(k)]     = s;
+    z[static_cast<std::size_t>(k + 1)] = far_away;
+  }
+  k = 0;
+  for (long long q = 0; q < n; ++q) {
+    while (z[static_cast<std::size_t>(k + 1)] < static_cast<float>(q)) {
+      ++k;
+    }
+    auto p          = v[static_cast<std::size_t>(k)];
+    d[q * stride] = static_cast<float>((q - p) * (q - p)) + at(p);
+  }
+}
+
+//! \brief Squared distance from every square to the nearest square where `is_target` is set, within a window.
+void squaredDistances(const std::vector<uint8_t>& is_target,
+                      long long width,
+                      long long height,
+                      std::vector<float>& result) {
+  std::vector<float> columns(is_target.size());
+  for (std::size_t i = 0; i < is_target.size(); ++i) {
+    columns[i] = is_target[i] ? 0.f : far_away;
+  }
+  result.resize(is_target.size());
+  std::vector<long long> v;
+  std::vector<float> z;
+  // Transform every column, then every row of the result.
+  for (long long x = 0; x < width; ++x) {
+    distanceTransform(&columns[static_cast<std::size_t>(x)], &result[static_cast<std::size_t>(x)], height, width, v, z);
+  }
+  for (long long y = 0; y < height; ++y) {
+    auto* row = &result[static_cast<std::size_t>(y * width)];
+    std::copy(row, row + width, &columns[static_cast<std::size_t>(y * width)]);
+    distanceTransform(&columns[static_cast<std::size_t>(y * width)], row, width, 1, v, z);
+  }
+}
+
+}  // namespace
+
+DistanceField::DistanceField(std::size_t width, std::size_t height, float max_distance, long long tile_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , max_distance_(max_distance)
+    , tile_size_(tile_size)
+    , tiles_x_((width_ + tile_size - 1) / tile_size)
+    , tiles_y_((height_ + tile_size - 1) / tile_size)
+    , distances_(width * height, max_distance)
+    , is_dirty_(static_cast<std::size_t>(tiles_x_ * tiles_y_), 1)
+    , solidity_hashes_(static_cast<std::size_t>(tiles_x_ * tiles_y_), 0) {}
+
+void DistanceField::Update(const World& world, utility::JobSystem& jobs) {
+  auto* tracker = world.GetChangeTracker();
+  if (needs_full_update_ || !tracker) {
+    std::ranges::fill(is_dirty_, 1);
+    jobs.ParallelFor(solidity_hashes_.size(), [&](std::size_t i) { solidity_hashes_[i] = hashSolidity(world, i); });
+    needs_full_update_ = false;
+  }
+  else if (seen_version_ < tracker->GetVersion()) {
+    // Only changes to which squares block rays move the terrain's surface.
+    for (std::size_t i = 0; i < solidity_hashes_.size(); ++i) {
+      const auto bounds = getTileBounds(i);
+      if (tracker->GetVersion(bounds) <= seen_version_) {
+        continue;
+      }
+      if (auto hash = hashSolidity(world, i); hash != solidity_hashes_[i]) {
+        solidity_hashes_[i] = hash;
+        markDirty(bounds);
+      }
+    }
+  }
+  if (tracker) {
+    seen_version_ = tracker->GetVersion();
+  }
+
+  std::vector<std::size_t> dirty_tiles;
+  for (std::size_t i = 0; i < is_dirty_.size(); ++i) {
+    if (is_dirty_[i]) {
+      dirty_tiles.push_back(i);
+      is_dirty_[i] = 0;
+    }
+  }
+  // Every tile only writes its own distances, so tiles can be recomputed independently.
+  jobs.ParallelFor(dirty_tiles.size(), [&](std::size_t i) { recomputeTile(world, dirty_tiles[i]); });
+}
+
+RayHit DistanceField::March(const RaySegment& ray) const {
+  RayHit hit;
+  const auto ray_length = length(ray.direction);
+  if (ray_length == 0.f) {
+    return hit;
+  }
+  const auto direction = ray.direction / ray_length;
+
+  // Distances are sampled at square centers, so a point within a square can be almost a square closer to the
+  // terrain than its square's distance. Steps leave that much room, and squares closer than twice that to the
+  // terrain are walked one at a time.
+  constexpr float margin = 1.f;
+
+  float t = 0.f;
+  while (t <= ray.max_distance) {
+    auto point = ray.origin + direction * t;
+    if (auto distance = GetDistance(point); 2 * margin < distance) {
+      t += distance - margin;
+      continue;
+    }
+
+    bool is_clear = false;
+    PVec2 previous {static_cast<long long>(std::floor(point.x)), static_cast<long long>(std::floor(point.y))};
+    TraverseGrid(point, direction, ray.max_distance - t, [&](PVec2 square, float distance_along) {
+      if (square.x < 0 || width_ <= square.x || square.y < 0 || height_ <= square.y) {
+        return false;
+      }
+      auto distance = GetDistance(square.x, square.y);
+      if (distance < 0.f) {
+        hit = {true, square, previous, t + distance_along};
+        return false;
+      }
+      if (0.f < distance_along && 2 * margin < distance) {
+        // Back in open space.
+        t += distance_along;
+        is_clear = true;
+        return false;
+      }
+      previous = square;
+      return true;
+    });
+    if (!is_clear) {
+      break;
+    }
+  }
+  return hit;
+}
+
+void DistanceField::markDirty(const BoundingBox& region) {
+  auto reach = region;
+  reach.Expand(static_cast<long long>(std::ceil(max_distance_)) + 1);
+  auto [x_min, x_max, y_min, y_max] = reach.Clip(width_, height_);
+  if (x_max < x_min || y_max < y_min) {
+    return;
+  }
+  for (auto ty = y_min / tile_size_; ty <= y_max / tile_size_; ++ty) {
+    for (auto tx = x_min / tile_size_; tx <= x_max / tile_size_; ++tx) {
+      is_dirty_[static_cast<std::size_t>(ty * tiles_x_ + tx)] = 1;
+    }
+  }
+}
+
+void DistanceField::recomputeTile(const World& world, std::size_t tile_index) {
+  const auto bounds = getTileBounds(tile_index);
+
+  // Everything within the maximum distance of the tile can affect it. The window is not clipped to the world, since
+  // squares outside the world are solid.
+  auto window = bounds;
+  window.Expand(static_cast<long long>(std::ceil(max_distance_)) + 1);
+  const auto width = window.x_max - window.x_min + 1, height = window.y_max - window.y_min + 1;
+
+  std::vector<uint8_t> is_solid(static_cast<std::size_t>(width * height), 1);
+  BlocksRay blocks;
+  for (auto y = window.y_min; y <= window.y_max; ++y) {
+    for (auto x = window.x_min; x <= window.x_max;) {
+      auto row = world.GetSquareRow(x, y, window.x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        is_solid[static_cast<std::size_t>((y - window.y_min) * width + (x - window.x_min))] = blocks(square);
+        ++x;
+      }
+    }
+  }
+
+  std::vector<float> to_solid, to_empty;
+  squaredDistances(is_solid, width, height, to_solid);
+  for (auto& solid : is_solid) {
+    solid = !solid;
+  }
+  squaredDistances(is_solid, width, height, to_empty);
+
+  for (auto y = bounds.y_min; y <= bounds.y_max; ++y) {
+    for (auto x = bounds.x_min; x <= bounds.x_max; ++x) {
+      auto i = static_cast<std::size_t>((y - window.y_min) * width + (x - window.x_min));
+      // Exactly one of the two is zero, the one for the kind of square this is.
+      auto distance = 0.f < to_solid[i] ? std::sqrt(to_solid[i]) - 0.5f : 0.5f - std::sqrt(to_empty[i]);
+      distances_[static_cast<std::size_t>(y * width_ + x)] = std::clamp(distance, -max_distance_, max_distance_);
+    }
+  }
+}
+
+uint64_t DistanceField::hashSolidity(const World& world, std::size_t tile_index) const {
+  // FNV-1a over whether each square of the tile blocks rays.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto bounds   = getTileBounds(tile_index);
+  BlocksRay blocks;
+  for (auto y = bounds.y_min; y <= bounds.y_max; ++y) {
+    for (auto x = bounds.x_min; x <= bounds.x_max;) {
+      auto row = world.GetSquareRow(x, y, bounds.x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        hash = (hash ^ static_cast<uint64_t>(blocks(square))) * 0x100000001b3ull;
+        ++x;
+      }
+    }
+  }
+  return hash;
+}
+
+BoundingBox DistanceField::getTileBounds(std::size_t tile_index) const {
+  auto tx = static_cast<long long>(tile_index) % tiles_x_;
+  auto ty = static_cast<long long>(tile_index) / tiles_x_;
+  return {tx * tile_size_,
+          std::min((tx + 1) * tile_size_, width_) - 1,
+          ty * tile_size_,
+          std::min((ty + 1) * tile_size_, height_) - 1};
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "pixelengine/utility/JobSystem.h"
+#include "pixelengine/world/ChangeTracker.h"
+#include "pixelengine/world/RayCast.h"
+
+namespace pixelengine::world {
+
+//! \brief The signed distance from every square of a (finite) world to the surface of the solid terrain, i.e.
+//!        squares that block rays.
+//!
+//! Distances are positive outside of the terrain and negative inside it, measured between square centers with the
+//! surface halfway between squares, and clamped to +/- the maximum distance. Because of the clamp, a change only
+//! affects distances within the maximum distance of it, so only the tiles near changes are recomputed, each with an
+//! exact two pass (Felzenszwalb) distance transform over the tile and its surroundings.
+//!
+//! The world's change tracker also reports squares that changed without changing what blocks rays, like water
+//! flowing. So the field hashes which squares of each changed tile block rays, and only recomputes around tiles where
+//! that changed.
+class DistanceField {
+public:
+  DistanceField() = default;
+
+  DistanceField(std::size_t width, std::size_t height, float max_distance = 16.f, long long tile_size = 32);
+
+  //! \brief Bring the distances up to date with the world, recomputing tiles near changes on the job system.
+  void Update(const World& world, utility::JobSystem& jobs);
+
+  //! \brief Get the signed distance at a square. Squares outside the world are solid.
+  [[nodiscard]] float GetDistance(long long x, long long y) const {
+    if (x < 0 || width_ <= x || y < 0 || height_ <= y) {
+      return -max_distance_;
+    }
+    return distances_[static_cast<std::size_t>(y * width_ + x)];
+  }
+
+  //! \brief Get the signed distance at the square containing a point.
+  [[nodiscard]] float GetDistance(Vec2 point) const {
+    return GetDistance(static_cast<long long>(std::floor(point.x)), static_cast<long long>(std::floor(point.y)));
+  }
+
+  [[nodiscard]] float GetMaxDistance() const { return max_distance_; }
+
+  //! \brief March a ray through the field, taking steps as large as the distance to the terrain allows, and only
+  //!        stepping square by square close to the terrain. Finds the same first hit as casting the ray square by
+  //!        square against squares that block rays.
+  [[nodiscard]] RayHit March(const RaySegment& ray) const;
+
+private:
+  //! \brief Mark every tile within the maximum distance of the region as needing to be recomputed.
+  void markDirty(const BoundingBox& region);
+
+  //! \brief Recompute the distances within a single tile.
+  void recomputeTile(const World& world, std::size_t tile_index);
+
+  [[nodiscard]] BoundingBox getTileBounds(std::size_t tile_index) const;
+
+  //! \brief Hash which squares of a tile block rays.
+  [[nodiscard]] uint64_t hashSolidity(const World& world, std::size_t tile_index) const;
+
+  long long width_ = 0, height_ = 0;
+  float max_distance_ = 16.f;
+
+  long long tile_size_ = 32;
+  long long tiles_x_ = 0, tiles_y_ = 0;
+
+  std::vector<float> distances_;
+  std::vector<uint8_t> is_dirty_;
+
+  //! \brief The hash of which squares of each tile blocked rays, when the tile was last checked.
+  std::vector<uint64_t> solidity_hashes_;
+
+  //! \brief The newest world change that the distances account for.
+  uint64_t seen_version_ = 0;
+
+  bool needs_full_update_ = true;
+};
+
+}  // namespace pixelengine::world
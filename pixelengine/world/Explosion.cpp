@@ -0,0 +1,146 @@
+#include "pixelengine/world/Explosion.h"
+// Other files.
+#include <numbers>
+
+namespace pixelengine::world {
+
+namespace {
+
+//! \brief How many rays an explosion casts, enough that neighboring rays at the edge of the blast are less than
+//!        a square apart.
+std::size_t numberOfRays(float radius) {
+  return std::max<std::size_t>(8, static_cast<std::size_t>(std::ceil(2.f * std::numbers::pi_v<float> * radius * 1.5f)));
+}
+
+//! \brief Snapshot value for squares outside the world, which stop rays.
+constexpr float outside_world = -1.f;
+
+//! \brief The largest region that a group of blasts will copy out of the world at once.
+constexpr long long max_snapshot_squares = 1 << 20;
+
+//! \brief The squares a blast can reach.
+BoundingBox reachOf(const Blast& blast) {
+  auto reach = static_cast<long long>(std::ceil(blast.settings.radius));
+  auto x = static_cast<long long>(std::floor(blast.center.x)), y = static_cast<long long>(std::floor(blast.center.y));
+  return {x - reach, x + reach, y - reach, y + reach};
+}
+
+//! \brief Set off blasts that all lie within the region, reading the region from the world once and writing the
+//!        destruction back in a single pass.
+std::size_t explodeWithin(World& world,
+                          std::span<const Blast* const> blasts,
+                          const BoundingBox& region,
+                          const Square& empty_square,
+                          ParticleSystem* particles) {
+  // The mass of whatever occupies each square, zero for empty squares.
+  RegionSnapshot<float> masses(world, region, outside_world, [](const Square& square) {
+    return square.is_occupied ? square.material->mass : 0.f;
+  });
+
+  const auto width = region.x_max - region.x_min + 1;
+  std::vector<uint8_t> destroyed(static_cast<std::size_t>(width * (region.y_max - region.y_min + 1)), 0);
+  auto index = [&](PVec2 square) {
+    return static_cast<std::size_t>((square.y - region.y_min) * width + (square.x - region.x_min));
+  };
+
+  for (auto* blast : blasts) {
+    auto& settings = blast->settings;
+    auto num_rays  = numberOfRays(settings.radius);
+    for (std::size_t i = 0; i < num_rays; ++i) {
+      auto angle = 2.f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(num_rays);
+      float spent     = 0.f;
+      Vec2 direction {std::cos(angle), std::sin(angle)};
+      TraverseGrid(blast->center, direction, settings.radius, [&](PVec2 square, float distance) {
+        auto mass = masses.Get(square.x, square.y);
+        if (mass == outside_world) {
+          return false;
+        }
+        if (mass == 0.f) {
+          return true;
+        }
+        auto cost = mass * settings.resistance;
+        if (settings.radius < distance + spent + cost) {
+          return false;
+        }
+        spent += cost;
+        destroyed[index(square)] = 1;
+        return true;
+      });
+    }
+  }
+
+  // Write all the destruction back to the world in one pass.
+  std::size_t num_destroyed = 0;
+  world.FillRectangle(region, [&](long long x, long long y, Square& square) {
+    if (!destroyed[index({x, y})] || !square.is_occupied) {
+      return;
+    }
+    ++num_destroyed;
+    if (particles) {
+      // Debris is thrown away from the nearest blast.
+      Vec2 position {static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f};
+      auto* nearest = blasts.front();
+      for (auto* blast : blasts) {
+        if (length(position - blast->center) < length(position - nearest->center)) {
+          nearest = blast;
+        }
+      }
+      if (randf() < nearest->settings.debris_fraction) {
+        auto offset = position - nearest->center;
+        auto direction = 0.f < length(offset) ? normalize(offset) : Vec2 {0.f, 1.f};
+        particles->AddParticle(position, direction * nearest->settings.debris_speed * (0.5f + randf()), square);
+      }
+    }
+    square = empty_square;
+  });
+  return num_destroyed;
+}
+
+}  // namespace
+
+std::size_t Explode(World& world, const Blast& blast, const Square& empty_square, ParticleSystem* particles) {
+  return Explode(world, std::span(&blast, 1), empty_square, particles);
+}
+
+std::size_t Explode(World& world, std::span<const Blast> blasts, const Square& empty_square, ParticleSystem* particles) {
+  // Group blasts whose reaches overlap, so blasts far apart do not share a region spanning all the space between
+  // them. Merging a blast into a group can make the group overlap others, so merging repeats until nothing changes.
+  std::vector<BoundingBox> regions;
+  std::vector<std::vector<const Blast*>> groups;
+  for (auto& blast : blasts) {
+    auto region = reachOf(blast);
+    std::vector<const Blast*> group {&blast};
+    for (std::size_t i = 0; i < regions.size();) {
+      if (regions[i].Intersection(region).IsEmpty()) {
+        ++i;
+        continue;
+      }
+      region.Update(regions[i]);
+      group.insert(group.end(), groups[i].begin(), groups[i].end());
+      regions[i] = regions.back();
+      groups[i]  = std::move(groups.back());
+      regions.pop_back();
+      groups.pop_back();
+      i = 0;
+    }
+    regions.push_back(region);
+    groups.push_back(std::move(group));
+  }
+
+  std::size_t num_destroyed = 0;
+  for (std::size_t i = 0; i < groups.size(); ++i) {
+    auto& region = regions[i];
+    auto area    = (region.x_max - region.x_min + 1) * (region.y_max - region.y_min + 1);
+    if (area <= max_snapshot_squares || groups[i].size() == 1) {
+      num_destroyed += explodeWithin(world, groups[i], region, empty_square, particles);
+      continue;
+    }
+    // A chain of overlapping blasts can still cover a huge area, set those blasts off one at a time.
+    for (auto* blast : groups[i]) {
+      num_destroyed += explodeWithin(world, std::span(&blast, 1), reachOf(*blast), empty_square, particles);
+    }
+  }
+  return num_destroyed;
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "pixelengine/world/ParticleSystem.h"
+#include "pixelengine/world/RayCast.h"
+
+namespace pixelengine::world {
+
+//! \brief Describes how strong an explosion is and what it leaves behind.
+struct ExplosionSettings {
+  //! \brief How far, in squares, the explosion reaches through empty space.
+  float radius = 10.f;
+
+  //! \brief How much of a ray's reach destroying a square costs, per unit of the square's material mass.
+  float resistance = 1.f;
+
+  //! \brief The fraction of destroyed squares that are thrown out as debris particles, if a particle system is
+  //!        given. The rest are simply removed.
+  float debris_fraction = 0.25f;
+
+  //! \brief The speed, in squares per second, that debris is thrown outwards with.
+  float debris_speed = 60.f;
+};
+
+//! \brief An explosion at a point in the world.
+struct Blast {
+  Vec2 center;
+  ExplosionSettings settings;
+};
+
+//! \brief Carve out the squares destroyed by an explosion, replacing them with the empty square.
+//!
+//! Rays are cast outwards from the center. Each ray loses reach with distance and with the mass of every square
+//! it destroys, so dense materials shield what is behind them. Returns the number of squares destroyed.
+std::size_t Explode(World& world,
+                    const Blast& blast,
+                    const Square& empty_square,
+                    ParticleSystem* particles = nullptr);
+
+//! \brief Set off many explosions at once. Blasts whose reaches overlap are grouped, and the squares each group
+//!        can reach are read from the world once and the destroyed squares written back in a single pass, so this
+//!        is much cheaper than exploding them one at a time. A group that would cover a very large area is set off
+//!        one blast at a time instead. Returns the total number of squares destroyed.
+std::size_t Explode(World& world,
+                    std::span<const Blast> blasts,
+                    const Square& empty_square,
+                    ParticleSystem* particles = nullptr);
+
+}  // namespace pixelengine::world
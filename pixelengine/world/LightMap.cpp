@@ -0,0 +1,254 @@
+#include "pixelengine/world/LightMap.h"
+// Other files.
+#include <array>
+#include <cmath>
+
+namespace pixelengine::world {
+
+namespace {
+
+//! \brief Convert a fraction of full brightness to a light level.
+uint8_t toLevel(float fraction) {
+  return static_cast<uint8_t>(std::clamp(std::round(fraction * 255.f), 0.f, 255.f));
+}
+
+//! \brief Whether a square stops sky light from shining straight down past it.
+bool blocksSky(const Square& square) {
+  return square.is_occupied && !square.material->IsGas();
+}
+
+//! \brief Working memory for relighting a tile, reused between tiles relit on the same thread.
+struct RelightScratch {
+  std::vector<uint8_t> costs;
+  std::vector<uint8_t> light;
+
+  //! \brief Squares waiting to spread their light, bucketed by light level.
+  std::array<std::vector<uint32_t>, 256> buckets;
+};
+
+}  // namespace
+
+LightMap::LightMap(std::size_t width, std::size_t height, long long tile_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , tile_size_(tile_size)
+    , tiles_x_((width_ + tile_size - 1) / tile_size)
+    , tiles_y_((height_ + tile_size - 1) / tile_size)
+    , min_cost_(std::max<uint8_t>(1, toLevel(AIR.light_attenuation)))
+    , levels_(width * height, 0)
+    , is_dirty_(static_cast<std::size_t>(tiles_x_ * tiles_y_), 1)
+    , sky_heights_(width, -1) {
+  range_ = (255 + min_cost_ - 1) / min_cost_;
+}
+
+void LightMap::Update(const World& world, utility::JobSystem& jobs) {
+  auto* tracker = world.GetChangeTracker();
+  if (needs_full_update_ || !tracker) {
+    updateSkyHeights(world, 0, width_ - 1);
+    std::ranges::fill(is_dirty_, 1);
+    needs_full_update_ = false;
+  }
+  else if (seen_version_ < tracker->GetVersion()) {
+    for (long long cy = 0; cy < tracker->GetNumChunksY(); ++cy) {
+      for (long long cx = 0; cx < tracker->GetNumChunksX(); ++cx) {
+        if (seen_version_ < tracker->GetChunkVersion(cx, cy)) {
+          auto bounds = tracker->GetChunkBounds(cx, cy);
+          updateSkyHeights(world, bounds.x_min, bounds.x_max);
+          markDirty(bounds);
+        }
+      }
+    }
+  }
+  if (tracker) {
+    seen_version_ = tracker->GetVersion();
+  }
+
+  std::vector<std::size_t> dirty_tiles;
+  for (std::size_t i = 0; i < is_dirty_.size(); ++i) {
+    if (is_dirty_[i]) {
+      dirty_tiles.push_back(i);
+      is_dirty_[i] = 0;
+    }
+  }
+  // Every tile only writes its own light levels, so tiles can be relit independently.
+  jobs.ParallelFor(dirty_tiles.size(), [&](std::size_t i) { relightTile(world, dirty_tiles[i]); });
+}
+
+void LightMap::SetSkyLevel(uint8_t level) {
+  if (level != sky_level_) {
+    sky_level_ = level;
+    std::ranges::fill(is_dirty_, 1);
+  }
+}
+
+void LightMap::SetAmbientLevel(uint8_t level) {
+  if (level != ambient_level_) {
+    ambient_level_ = level;
+    std::ranges::fill(is_dirty_, 1);
+  }
+}
+
+std::size_t LightMap::AddLight(const PointLight& light) {
+  requireInMap(light);
+  lights_.emplace_back(light);
+  markDirty({light.position.x, light.position.x, light.position.y, light.position.y});
+  return lights_.size() - 1;
+}
+
+void LightMap::SetLight(std::size_t id, const PointLight& light) {
+  requireInMap(light);
+  auto& current = lights_.at(id);
+  if (current) {
+    markDirty({current->position.x, current->position.x, current->position.y, current->position.y});
+  }
+  current = light;
+  markDirty({light.position.x, light.position.x, light.position.y, light.position.y});
+}
+
+void LightMap::RemoveLight(std::size_t id) {
+  auto& current = lights_.at(id);
+  if (current) {
+    markDirty({current->position.x, current->position.x, current->position.y, current->position.y});
+  }
+  current = {};
+}
+
+void LightMap::markDirty(const BoundingBox& region) {
+  auto reach = region;
+  reach.Expand(range_);
+  auto [x_min, x_max, y_min, y_max] = reach.Clip(width_, height_);
+  if (x_max < x_min || y_max < y_min) {
+    return;
+  }
+  for (auto ty = y_min / tile_size_; ty <= y_max / tile_size_; ++ty) {
+    for (auto tx = x_min / tile_size_; tx <= x_max / tile_size_; ++tx) {
+      is_dirty_[static_cast<std::size_t>(ty * tiles_x_ + tx)] = 1;
+    }
+  }
+}
+
+void LightMap::updateSkyHeights(const World& world, long long x_min, long long x_max) {
+  for (auto x = std::max(0ll, x_min); x <= std::min(width_ - 1, x_max); ++x) {
+    auto height = -1ll;
+    for (auto y = height_ - 1; 0 <= y; --y) {
+      if (blocksSky(world.GetSquare(x, y))) {
+        height = y;
+        break;
+      }
+    }
+    auto& current = sky_heights_[static_cast<std::size_t>(x)];
+    if (height != current) {
+      // Every square between the old and new heights either gained or lost the sky.
+      markDirty({x, x, std::min(height, current) + 1, std::max(height, current)});
+      current = height;
+    }
+  }
+}
+
+void LightMap::relightTile(const World& world, std::size_t tile_index) {
+  thread_local RelightScratch scratch;
+
+  const auto bounds = getTileBounds(tile_index);
+  auto reach        = bounds;
+  reach.Expand(range_);
+  auto [x_min, x_max, y_min, y_max] = reach.Clip(width_, height_);
+  const auto width = x_max - x_min + 1, height = y_max - y_min + 1;
+
+  auto& costs = scratch.costs;
+  auto& light = scratch.light;
+  costs.assign(static_cast<std::size_t>(width * height), 0);
+  light.assign(static_cast<std::size_t>(width * height), 0);
+
+  auto seed = [&](std::size_t index, uint8_t level) {
+    if (light[index] < level) {
+      light[index] = level;
+      scratch.buckets[level].push_back(static_cast<uint32_t>(index));
+    }
+  };
+
+  // Read the squares that light could reach the tile from.
+  for (auto y = y_min; y <= y_max; ++y) {
+    for (auto x = x_min; x <= x_max;) {
+      auto row = world.GetSquareRow(x, y, x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        auto index   = static_cast<std::size_t>((y - y_min) * width + (x - x_min));
+        costs[index] = getCost(square);
+        if (square.is_occupied) {
+          seed(index, toLevel(square.material->light_emission));
+        }
+        if (sky_heights_[static_cast<std::size_t>(x)] < y) {
+          seed(index, sky_level_);
+        }
+        ++x;
+      }
+    }
+  }
+  for (auto& point_light : lights_) {
+    // Only lights in the part of the reach that is in the map have a square to seed.
+    if (point_light && x_min <= point_light->position.x && point_light->position.x <= x_max
+        && y_min <= point_light->position.y && point_light->position.y <= y_max)
+    {
+      seed(static_cast<std::size_t>((point_light->position.y - y_min) * width + (point_light->position.x - x_min)),
+           point_light->level);
+    }
+  }
+
+  // Spread light from the brightest squares to the dimmest. Light only ever moves to lower buckets, so each
+  // square is settled the first time it is taken out of a bucket at its current level.
+  for (int level = 255; 0 < level; --level) {
+    auto& bucket = scratch.buckets[level];
+    while (!bucket.empty()) {
+      auto index = bucket.back();
+      bucket.pop_back();
+      if (light[index] != level) {
+        continue;
+      }
+      auto x = static_cast<long long>(index % width), y = static_cast<long long>(index / width);
+      auto spread = [&](long long nx, long long ny) {
+        if (nx < 0 || width <= nx || ny < 0 || height <= ny) {
+          return;
+        }
+        auto neighbor = static_cast<std::size_t>(ny * width + nx);
+        if (costs[neighbor] < level) {
+          seed(neighbor, static_cast<uint8_t>(level - costs[neighbor]));
+        }
+      };
+      spread(x - 1, y);
+      spread(x + 1, y);
+      spread(x, y - 1);
+      spread(x, y + 1);
+    }
+  }
+
+  for (auto y = bounds.y_min; y <= bounds.y_max; ++y) {
+    for (auto x = bounds.x_min; x <= bounds.x_max; ++x) {
+      auto level = light[static_cast<std::size_t>((y - y_min) * width + (x - x_min))];
+      levels_[static_cast<std::size_t>(y * width_ + x)] = std::max(level, ambient_level_);
+    }
+  }
+}
+
+BoundingBox LightMap::getTileBounds(std::size_t tile_index) const {
+  auto tx = static_cast<long long>(tile_index) % tiles_x_;
+  auto ty = static_cast<long long>(tile_index) / tiles_x_;
+  return {tx * tile_size_,
+          std::min((tx + 1) * tile_size_, width_) - 1,
+          ty * tile_size_,
+          std::min((ty + 1) * tile_size_, height_) - 1};
+}
+
+void LightMap::requireInMap(const PointLight& light) const {
+  PIXEL_REQUIRE(0 <= light.position.x && light.position.x < width_ && 0 <= light.position.y
+                    && light.position.y < height_,
+                "point light at " << light.position << " is outside the light map");
+}
+
+uint8_t LightMap::getCost(const Square& square) const {
+  return std::max(min_cost_, toLevel(square.material->light_attenuation));
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <optional>
+#include <span>
+
+#include "pixelengine/utility/JobSystem.h"
+#include "pixelengine/world/ChangeTracker.h"
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::world {
+
+//! \brief A light that is not attached to a square, e.g. a torch that the player is carrying.
+struct PointLight {
+  PVec2 position;
+  uint8_t level = 255;
+};
+
+//! \brief The light level of every square of a (finite) world, from the sky, from glowing materials, and from
+//!        point lights.
+//!
+//! Light spreads outwards from its sources, losing some of its level for every square it passes into, according
+//! to the material's light attenuation, so solid squares quickly block it. Squares that can see straight up to
+//! the top of the world are lit by the sky. Levels go from 0 (dark) to 255 (full daylight).
+//!
+//! The map is divided into tiles. When the world changes, only the tiles that light from the changed squares could
+//! reach are recomputed, each tile independently, in parallel.
+class LightMap {
+public:
+  LightMap() = default;
+
+  LightMap(std::size_t width, std::size_t height, long long tile_size = 32);
+
+  //! \brief Bring the light levels up to date with the world, recomputing dirty tiles on the job system.
+  void Update(const World& world, utility::JobSystem& jobs);
+
+  [[nodiscard]] uint8_t GetLevel(long long x, long long y) const {
+    return levels_[static_cast<std::size_t>(y * width_ + x)];
+  }
+
+  //! \brief Get the light level of every square, row by row, starting from y = 0.
+  [[nodiscard]] std::span<const uint8_t> GetLevels() const { return levels_; }
+
+  //! \brief Get the light level as a brightness, from 0 to 1.
+  [[nodiscard]] float GetBrightness(long long x, long long y) const {
+    return static_cast<float>(GetLevel(x, y)) / 255.f;
+  }
+
+  //! \brief Set how bright the sky is. Changing the sky relights the whole map.
+  void SetSkyLevel(uint8_t level);
+
+  //! \brief Set the least light level that any square has, so unlit areas are not completely black.
+  void SetAmbientLevel(uint8_t level);
+
+  //! \brief Add a point light, returning an id for it. The light must be within the map.
+  std::size_t AddLight(const PointLight& light);
+
+  //! \brief Move or change the level of a point light. The light must stay within the map.
+  void SetLight(std::size_t id, const PointLight& light);
+
+  void RemoveLight(std::size_t id);
+
+private:
+  //! \brief Mark every tile that light in or passing through the region could reach as needing to be relit.
+  void markDirty(const BoundingBox& region);
+
+  //! \brief Recompute the highest sky blocking square in every column in [x_min, x_max], marking any column
+  //!        whose sky exposure changed as dirty.
+  void updateSkyHeights(const World& world, long long x_min, long long x_max);
+
+  //! \brief Recompute the light levels within a single tile.
+  void relightTile(const World& world, std::size_t tile_index);
+
+  [[nodiscard]] BoundingBox getTileBounds(std::size_t tile_index) const;
+
+  void requireInMap(const PointLight& light) const;
+
+  //! \brief The light level lost when entering a square.
+  [[nodiscard]] uint8_t getCost(const Square& square) const;
+
+  long long width_ = 0, height_ = 0;
+
+  long long tile_size_ = 32;
+  long long tiles_x_ = 0, tiles_y_ = 0;
+
+  //! \brief The furthest distance, in squares, that any light can travel. Tiles are relit using the squares within
+  //!        this distance of them.
+  long long range_ = 0;
+
+  //! \brief The smallest cost of entering a square, the cost of entering an empty square.
+  uint8_t min_cost_ = 16;
+
+  uint8_t sky_level_     = 255;
+  uint8_t ambient_level_ = 0;
+
+  std::vector<uint8_t> levels_;
+
+  //! \brief Whether each tile needs to be relit.
+  std::vector<uint8_t> is_dirty_;
+
+  //! \brief The height of the highest square in each column that blocks the sky, or -1 if there is none.
+  std::vector<long long> sky_heights_;
+
+  std::vector<std::optional<PointLight>> lights_;
+
+  //! \brief The newest world change that the light levels account for.
+  uint64_t seen_version_ = 0;
+
+  bool needs_full_update_ = true;
+};
+
+}  // namespace pixelengine::world
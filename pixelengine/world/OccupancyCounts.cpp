@@ -0,0 +1,140 @@
+#include "pixelengine/world/OccupancyCounts.h"
+
+namespace pixelengine::world {
+
+OccupancyCounts::OccupancyCounts(std::size_t width, std::size_t height, long long chunk_size)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height))
+    , chunk_size_(chunk_size)
+    , chunks_x_((width_ + chunk_size - 1) / chunk_size)
+    , chunks_y_((height_ + chunk_size - 1) / chunk_size)
+    , chunks_(static_cast<std::size_t>(chunks_x_ * chunks_y_))
+    , totals_(static_cast<std::size_t>((chunks_x_ + 1) * (chunks_y_ + 1))) {}
+
+SquareCounts OccupancyCounts::Count(const World& world, const BoundingBox& region) const {
+  if (region.IsEmpty() || region.y_max < region.y_min) {
+    return {};
+  }
+  if (!isCurrent(world)) {
+    return world.World::CountSquares(region);
+  }
+  auto [x_min, x_max, y_min, y_max] = BoundingBox(region).Clip(width_, height_);
+
+  // Everything outside the world is solid.
+  const auto area = static_cast<uint32_t>((region.x_max - region.x_min + 1) * (region.y_max - region.y_min + 1));
+  if (x_max < x_min || y_max < y_min) {
+    return {area, 0};
+  }
+  const auto inside = static_cast<uint32_t>((x_max - x_min + 1) * (y_max - y_min + 1));
+  SquareCounts counts {area - inside, 0};
+
+  const auto cx0 = x_min / chunk_size_, cx1 = x_max / chunk_size_;
+  const auto cy0 = y_min / chunk_size_, cy1 = y_max / chunk_size_;
+
+  // The chunks the rectangle covers completely.
+  const auto full_x0 = (x_min + chunk_size_ - 1) / chunk_size_, full_y0 = (y_min + chunk_size_ - 1) / chunk_size_;
+  auto full_x1 = (x_max + 1) / chunk_size_ - 1, full_y1 = (y_max + 1) / chunk_size_ - 1;
+  // The last chunks are complete if the rectangle reaches the edge of the world.
+  if (x_max == width_ - 1) {
+    full_x1 = chunks_x_ - 1;
+  }
+  if (y_max == height_ - 1) {
+    full_y1 = chunks_y_ - 1;
+  }
+  const bool has_full = full_x0 <= full_x1 && full_y0 <= full_y1;
+  if (has_full) {
+    counts += totalsSum(full_x0, full_x1 + 1, full_y0, full_y1 + 1);
+  }
+
+  // Every other chunk the rectangle overlaps is partly covered.
+  for (auto cy = cy0; cy <= cy1; ++cy) {
+    for (auto cx = cx0; cx <= cx1; ++cx) {
+      if (has_full && full_x0 <= cx && cx <= full_x1 && full_y0 <= cy && cy <= full_y1) {
+        continue;
+      }
+      auto& chunk  = chunks_[static_cast<std::size_t>(cy * chunks_x_ + cx)];
+      auto local_x = cx * chunk_size_, local_y = cy * chunk_size_;
+      counts += chunk.Sum(std::max(x_min, local_x) - local_x,
+                          std::min(x_max + 1, local_x + chunk.width) - local_x,
+                          std::max(y_min, local_y) - local_y,
+                          std::min(y_max + 1, local_y + chunk.height) - local_y);
+    }
+  }
+  return counts;
+}
+
+void OccupancyCounts::Update(const World& world) {
+  if (isCurrent(world)) {
+    return;  // Nothing in the world changed since the last update.
+  }
+  auto* tracker = world.GetChangeTracker();
+
+  for (long long cy = 0; cy < chunks_y_; ++cy) {
+    for (long long cx = 0; cx < chunks_x_; ++cx) {
+      auto& chunk = chunks_[static_cast<std::size_t>(cy * chunks_x_ + cx)];
+      // Without a change tracker, there is no way to know whether a chunk changed.
+      if (!chunk.is_built || !tracker || chunk.version != tracker->GetVersion(chunkBounds(cx, cy))) {
+        buildChunk(world, cx, cy);
+      }
+    }
+  }
+  if (are_totals_stale_) {
+    const auto stride = chunks_x_ + 1;
+    for (long long cy = 0; cy < chunks_y_; ++cy) {
+      SquareCounts row;
+      for (long long cx = 0; cx < chunks_x_; ++cx) {
+        auto& chunk = chunks_[static_cast<std::size_t>(cy * chunks_x_ + cx)];
+        row += chunk.Sum(0, chunk.width, 0, chunk.height);
+        totals_[static_cast<std::size_t>((cy + 1) * stride + cx + 1)] =
+            totals_[static_cast<std::size_t>(cy * stride + cx + 1)] + row;
+      }
+    }
+    are_totals_stale_ = false;
+  }
+  seen_version_ = tracker ? tracker->GetVersion() : 0;
+  is_built_     = true;
+}
+
+void OccupancyCounts::buildChunk(const World& world, long long cx, long long cy) {
+  auto& chunk  = chunks_[static_cast<std::size_t>(cy * chunks_x_ + cx)];
+  auto x_begin = cx * chunk_size_, y_begin = cy * chunk_size_;
+  chunk.width  = std::min(chunk_size_, width_ - x_begin);
+  chunk.height = std::min(chunk_size_, height_ - y_begin);
+  chunk.sums.assign(static_cast<std::size_t>((chunk.width + 1) * (chunk.height + 1)), {});
+
+  const auto stride = chunk.width + 1;
+  for (long long j = 0; j < chunk.height; ++j) {
+    SquareCounts row;
+    auto x = x_begin;
+    while (x < x_begin + chunk.width) {
+      auto squares = world.GetSquareRow(x, y_begin + j, x_begin + chunk.width - x);
+      if (squares.empty()) {
+        ++x;
+        continue;
+      }
+      for (auto& square : squares) {
+        if (square.is_occupied) {
+          row.solid += square.material->IsSolidOrPowder();
+          row.fluid += square.material->IsLiquidOrGas();
+        }
+        auto i = x - x_begin;
+        chunk.sums[static_cast<std::size_t>((j + 1) * stride + i + 1)] =
+            chunk.sums[static_cast<std::size_t>(j * stride + i + 1)] + row;
+        ++x;
+      }
+    }
+  }
+
+  auto* tracker = world.GetChangeTracker();
+  chunk.version  = tracker ? tracker->GetVersion(chunkBounds(cx, cy)) : 0;
+  chunk.is_built    = true;
+  are_totals_stale_ = true;
+}
+
+SquareCounts OccupancyCounts::totalsSum(long long cx0, long long cx1, long long cy0, long long cy1) const {
+  const auto stride = chunks_x_ + 1;
+  auto at           = [&](long long x, long long y) { return totals_[static_cast<std::size_t>(y * stride + x)]; };
+  return at(cx1, cy1) + at(cx0, cy0) - at(cx0, cy1) - at(cx1, cy0);
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "pixelengine/world/ChangeTracker.h"
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::world {
+
+//! \brief Counts the solid and fluid squares in any rectangle of a (finite) world in constant time, e.g. to check
+//!        whether an area is clear.
+//!
+//! Each chunk of the world keeps a summed-area table of its squares, which Update rebuilds if the chunk's version in
+//! the world's change tracker changed since it was built. A summed-area table of the chunk totals covers the chunks a
+//! rectangle contains completely, so a rectangle within one chunk takes four lookups, and any other rectangle four
+//! lookups per chunk it partly overlaps, plus four.
+//!
+//! Queries never change the tables, so they can be made from several threads at once, e.g. by bodies in parallel
+//! subtrees. If the world changed since the last Update, a query counts the squares directly instead.
+class OccupancyCounts {
+public:
+  OccupancyCounts() = default;
+
+  OccupancyCounts(std::size_t width, std::size_t height, long long chunk_size = 32);
+
+  //! \brief Rebuild the tables of any chunks that changed since they were built, and the table of totals if any did.
+  void Update(const World& world);
+
+  //! \brief Count the squares of each kind within the (inclusive) rectangle.
+  [[nodiscard]] SquareCounts Count(const World& world, const BoundingBox& region) const;
+
+  //! \brief Whether there are no solid squares in the rectangle.
+  [[nodiscard]] bool IsClear(const World& world, const BoundingBox& region) const {
+    return Count(world, region).solid == 0;
+  }
+
+private:
+  struct ChunkTable {
+    //! \brief The world's version of the chunk when the table was built.
+    uint64_t version = 0;
+    bool is_built = false;
+
+    long long width = 0, height = 0;
+
+    //! \brief Counts of the squares below and to the left of each corner, (width + 1) by (height + 1).
+    std::vector<SquareCounts> sums;
+
+    //! \brief Count the squares in the rectangle, in coordinates local to the chunk, with exclusive upper bounds.
+    [[nodiscard]] SquareCounts Sum(long long x0, long long x1, long long y0, long long y1) const {
+      auto at = [&](long long x, long long y) { return sums[static_cast<std::size_t>(y * (width + 1) + x)]; };
+      return at(x1, y1) + at(x0, y0) - at(x0, y1) - at(x1, y0);
+    }
+  };
+
+  //! \brief Whether the tables are up to date with the world.
+  [[nodiscard]] bool isCurrent(const World& world) const {
+    auto* tracker = world.GetChangeTracker();
+    return tracker && is_built_ && tracker->GetVersion() == seen_version_;
+  }
+
+  void buildChunk(const World& world, long long cx, long long cy);
+
+  [[nodiscard]] BoundingBox chunkBounds(long long cx, long long cy) const {
+    return {cx * chunk_size_, (cx + 1) * chunk_size_ - 1, cy * chunk_size_, (cy + 1) * chunk_size_ - 1};
+  }
+
+  [[nodiscard]] SquareCounts totalsSum(long long cx0, long long cx1, long long cy0, long long cy1) const;
+
+  long long width_ = 0, height_ = 0;
+  long long chunk_size_ = 32;
+  long long chunks_x_ = 0, chunks_y_ = 0;
+
+  std::vector<ChunkTable> chunks_;
+
+  //! \brief Summed-area table of the totals of every chunk, (chunks_x + 1) by (chunks_y + 1).
+  std::vector<SquareCounts> totals_;
+  bool are_totals_stale_ = true;
+
+  //! \brief Whether Update has been called at least once.
+  bool is_built_ = false;
+
+  //! \brief The version of the whole world when the tables were last brought up to date.
+  uint64_t seen_version_ = 0;
+};
+
+}  // namespace pixelengine::world
@@ -0,0 +1,169 @@
+#include "pixelengine/world/OccupancyPyramid.h"
+// Other files.
+#include <limits>
+
+namespace pixelengine::world {
+
+OccupancyPyramid::OccupancyPyramid(std::size_t width, std::size_t height)
+    : width_(static_cast<long long>(width))
+    , height_(static_cast<long long>(height)) {
+  // Halve the resolution until a single block covers the whole world.
+  long long level_width = width_, level_height = height_;
+  while (true) {
+    levels_.push_back({level_width, level_height, std::vector<uint32_t>(static_cast<std::size_t>(level_width * level_height), 0)});
+    if (level_width <= 1 && level_height <= 1) {
+      break;
+    }
+    level_width  = (level_width + 1) / 2;
+    level_height = (level_height + 1) / 2;
+  }
+}
+
+void OccupancyPyramid::Update(const World& world) {
+  BlocksRay blocks;
+  auto rescan = [&](const BoundingBox& region) {
+    for (auto y = region.y_min; y <= region.y_max; ++y) {
+      for (auto x = region.x_min; x <= region.x_max;) {
+        auto row = world.GetSquareRow(x, y, region.x_max - x + 1);
+        if (row.empty()) {
+          ++x;
+          continue;
+        }
+        for (auto& square : row) {
+          SetOccupied(x, y, blocks(square));
+          ++x;
+        }
+      }
+    }
+  };
+
+  auto* tracker = world.GetChangeTracker();
+  if (needs_full_update_ || !tracker) {
+    rescan({0, width_ - 1, 0, height_ - 1});
+    needs_full_update_ = false;
+  }
+  else if (seen_version_ < tracker->GetVersion()) {
+    for (long long cy = 0; cy < tracker->GetNumChunksY(); ++cy) {
+      for (long long cx = 0; cx < tracker->GetNumChunksX(); ++cx) {
+        if (seen_version_ < tracker->GetChunkVersion(cx, cy)) {
+          rescan(tracker->GetChunkBounds(cx, cy));
+        }
+      }
+    }
+  }
+  if (tracker) {
+    seen_version_ = tracker->GetVersion();
+  }
+}
+
+void OccupancyPyramid::SetOccupied(long long x, long long y, bool is_occupied) {
+  auto& square = levels_[0].counts[static_cast<std::size_t>(y * width_ + x)];
+  if ((0 < square) == is_occupied) {
+    return;
+  }
+  for (std::size_t level = 0; level < levels_.size(); ++level) {
+    auto& info  = levels_[level];
+    auto& count = info.counts[static_cast<std::size_t>((y >> level) * info.width + (x >> level))];
+    count       = is_occupied ? count + 1 : count - 1;
+  }
+}
+
+bool OccupancyPyramid::AnyOccupied(const BoundingBox& region) const {
+  if (region.IsEmpty() || region.y_max < region.y_min) {
+    return false;
+  }
+  // Parts of the region outside the world count as occupied. The blocks only cover the world, so this is checked
+  // before descending into them.
+  if (region.x_min < 0 || width_ <= region.x_max || region.y_min < 0 || height_ <= region.y_max) {
+    return true;
+  }
+  return anyOccupiedInBlock(levels_.size() - 1, 0, 0, region);
+}
+
+bool OccupancyPyramid::anyOccupiedInBlock(std::size_t level,
+                                          long long block_x,
+                                          long long block_y,
+                                          const BoundingBox& region) const {
+  const auto size = 1ll << level;
+  BoundingBox block {block_x * size, (block_x + 1) * size - 1, block_y * size, (block_y + 1) * size - 1};
+  auto overlap = block.Intersection(region);
+  if (overlap.IsEmpty()) {
+    return false;
+  }
+  if (GetCount(level, block_x, block_y) == 0) {
+    return false;
+  }
+  if (level == 0 || (overlap.x_min == block.x_min && overlap.x_max == block.x_max && overlap.y_min == block.y_min
+                     && overlap.y_max == block.y_max)) {
+    return true;
+  }
+  for (long long j = 0; j < 2; ++j) {
+    for (long long i = 0; i < 2; ++i) {
+      auto child_x = 2 * block_x + i, child_y = 2 * block_y + j;
+      auto& child  = levels_[level - 1];
+      if (child_x < child.width && child_y < child.height && anyOccupiedInBlock(level - 1, child_x, child_y, region)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+RayHit OccupancyPyramid::CastRay(const RaySegment& ray) const {
+  RayHit hit;
+  const auto ray_length = length(ray.direction);
+  if (ray_length == 0.f) {
+    return hit;
+  }
+  const auto direction = ray.direction / ray_length;
+
+  PVec2 previous {static_cast<long long>(std::floor(ray.origin.x)), static_cast<long long>(std::floor(ray.origin.y))};
+  // How far to nudge a point along the ray to move it off a boundary between squares. It grows with the coordinates,
+  // since far from zero a fixed nudge is lost to rounding, and the ray would stop advancing.
+  const auto origin_magnitude = std::max(std::abs(ray.origin.x), std::abs(ray.origin.y));
+  auto nudge = [origin_magnitude](float t) {
+    return std::max(1e-4f, 8.f * std::numeric_limits<float>::epsilon() * (origin_magnitude + t));
+  };
+
+  float t = 0.f;
+  // Walk square by square (like TraverseGrid), but jump to the far side of the largest empty block containing the
+  // current square whenever there is one.
+  while (t <= ray.max_distance) {
+    // Nudge forwards, so a point on the boundary between squares is in the square the ray is entering.
+    auto point = ray.origin + direction * (t + nudge(t));
+    PVec2 square {static_cast<long long>(std::floor(point.x)), static_cast<long long>(std::floor(point.y))};
+    if (square.x < 0 || width_ <= square.x || square.y < 0 || height_ <= square.y) {
+      break;
+    }
+    if (IsOccupied(square.x, square.y)) {
+      hit = {true, square, previous, t};
+      break;
+    }
+
+    std::size_t level = 0;
+    while (level + 1 < levels_.size() && GetCount(level + 1, square.x >> (level + 1), square.y >> (level + 1)) == 0) {
+      ++level;
+    }
+    const auto size = 1ll << level;
+    const auto x_min = static_cast<float>((square.x >> level) * size), y_min = static_cast<float>((square.y >> level) * size);
+    const auto x_max = x_min + static_cast<float>(size), y_max = y_min + static_cast<float>(size);
+
+    // Distance along the ray to where it leaves the block.
+    auto exit_x = 0.f < direction.x   ? (x_max - ray.origin.x) / direction.x
+                  : direction.x < 0.f ? (x_min - ray.origin.x) / direction.x
+                                      : std::numeric_limits<float>::infinity();
+    auto exit_y = 0.f < direction.y   ? (y_max - ray.origin.y) / direction.y
+                  : direction.y < 0.f ? (y_min - ray.origin.y) / direction.y
+                                      : std::numeric_limits<float>::infinity();
+    auto exit = std::max(t, std::min(exit_x, exit_y));
+
+    // The last square of the block that the ray passes through.
+    auto last = ray.origin + direction * std::max(t, exit - nudge(exit));
+    previous  = {std::clamp(static_cast<long long>(std::floor(last.x)), static_cast<long long>(x_min), static_cast<long long>(x_max) - 1),
+                 std::clamp(static_cast<long long>(std::floor(last.y)), static_cast<long long>(y_min), static_cast<long long>(y_max) - 1)};
+    t = std::max(exit, t + nudge(t));
+  }
+  return hit;
+}
+
+}  // namespace pixelengine::world
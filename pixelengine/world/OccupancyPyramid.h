@@ -0,0 +1,66 @@
+#pragma once
+
+#include "pixelengine/world/ChangeTracker.h"
+#include "pixelengine/world/RayCast.h"
+
+namespace pixelengine::world {
+
+//! \brief A mip pyramid of which squares of a (finite) world are occupied by squares that block rays.
+//!
+//! Level 0 is the squares themselves, and each square of level k + 1 covers a 2 x 2 block of level k, so level k
+//! covers 2^k x 2^k blocks of squares. Each level stores how many occupied squares each block contains, so a change
+//! to one square is applied to every level by adding or subtracting one, without looking at any other squares.
+//!
+//! Traversals use the pyramid to cross large empty blocks in one step, instead of square by square.
+class OccupancyPyramid {
+public:
+  OccupancyPyramid() = default;
+
+  OccupancyPyramid(std::size_t width, std::size_t height);
+
+  //! \brief Bring the pyramid up to date with every square the world has changed since the last update.
+  void Update(const World& world);
+
+  //! \brief Record that a single square became occupied or empty.
+  void SetOccupied(long long x, long long y, bool is_occupied);
+
+  [[nodiscard]] bool IsOccupied(long long x, long long y) const { return 0 < GetCount(0, x, y); }
+
+  //! \brief Get the number of occupied squares in a block of a level. Blocks are indexed in units of the block
+  //!        size, 2^level.
+  [[nodiscard]] uint32_t GetCount(std::size_t level, long long block_x, long long block_y) const {
+    auto& info = levels_[level];
+    return info.counts[static_cast<std::size_t>(block_y * info.width + block_x)];
+  }
+
+  //! \brief Whether any square within the region is occupied. Squares outside the world count as occupied.
+  [[nodiscard]] bool AnyOccupied(const BoundingBox& region) const;
+
+  //! \brief Cast a ray, skipping over the largest empty block around the ray at every step. Finds the same first hit
+  //!        as casting the ray square by square, except possibly for rays that pass exactly through the corner of
+  //!        an occupied square.
+  [[nodiscard]] RayHit CastRay(const RaySegment& ray) const;
+
+  [[nodiscard]] std::size_t GetNumLevels() const { return levels_.size(); }
+
+private:
+  struct Level {
+    long long width = 0, height = 0;
+    std::vector<uint32_t> counts;
+  };
+
+  //! \brief Whether any square in both the block of the given level and the region is occupied. The region must be
+  //!        within the world.
+  [[nodiscard]] bool anyOccupiedInBlock(std::size_t level, long long block_x, long long block_y, const BoundingBox& region) const;
+
+  long long width_ = 0, height_ = 0;
+
+  std::vector<Level> levels_;
+
+  //! \brief The newest world change that the pyramid accounts for.
+  uint64_t seen_version_ = 0;
+
+  bool needs_full_update_ = true;
+};
+
+}  // namespace pixelengine::world
@@ -0,0 +1,176 @@
+#include "pixelengine/world/ParticleSystem.h"
+// Other files.
+#include "pixelengine/utility/PathGenerator.h"
+
+namespace pixelengine::world {
+
+namespace {
+
+PVec2 toSquare(float x, float y) {
+  return {static_cast<long long>(std::floor(x)), static_cast<long long>(std::floor(y))};
+}
+
+bool isFree(const World& world, PVec2 square) {
+  return world.IsValidSquare(square) && !world.GetSquare(square).is_occupied;
+}
+
+//! \brief Find the free square closest to `center`, searching rings of growing size out to `max_radius`.
+std::optional<PVec2> findFreeSquareNear(const World& world, PVec2 center, long long max_radius) {
+  for (long long radius = 1; radius <= max_radius; ++radius) {
+    std::optional<PVec2> closest {};
+    long long closest_distance = 0;
+    for (auto dy = -radius; dy <= radius; ++dy) {
+      for (auto dx = -radius; dx <= radius; ++dx) {
+        // Only the squares on the edge of the ring are new.
+        if (std::abs(dx) != radius && std::abs(dy) != radius) {
+          continue;
+        }
+        PVec2 square {center.x + dx, center.y + dy};
+        auto distance = dx * dx + dy * dy;
+        if (isFree(world, square) && (!closest || distance < closest_distance)) {
+          closest          = square;
+          closest_distance = distance;
+        }
+      }
+    }
+    if (closest) {
+      return closest;
+    }
+  }
+  return {};
+}
+
+//! \brief How far a buried particle is pushed to find a free square to land in.
+constexpr long long max_push_out = 8;
+
+}  // namespace
+
+void ParticleSystem::AddParticle(Vec2 position, Vec2 velocity, const Square& square) {
+  x_.push_back(position.x);
+  y_.push_back(position.y);
+  vx_.push_back(velocity.x);
+  vy_.push_back(velocity.y);
+  last_x_.push_back(position.x);
+  last_y_.push_back(position.y);
+  last_free_.push_back(toSquare(position.x, position.y));
+  color_.push_back(square.color);
+  material_.push_back(square.material);
+  behavior_.push_back(square.behavior);
+}
+
+bool ParticleSystem::Eject(World& world, long long x, long long y, Vec2 velocity) {
+  if (!world.IsValidSquare(x, y)) {
+    return false;
+  }
+  auto square = world.GetSquare(x, y);
+  if (!square.is_occupied) {
+    return false;
+  }
+  world.SetSquare(x, y, empty_square_);
+  // Start in the middle of the square.
+  AddParticle({static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f}, velocity, square);
+  return true;
+}
+
+void ParticleSystem::_interactWithWorld(World* world) {
+  Node::_interactWithWorld(world);
+  if (!world) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < Size();) {
+    // Walk the squares the particle passed through during the last step, starting from the last free square it
+    // was in, if that is still free. A particle can start a step inside occupied squares, e.g. if sand fell onto
+    // it, so the free square may have been passed on an earlier step.
+    PathGenerator path(toSquare(last_x_[i], last_y_[i]), toSquare(x_[i], y_[i]));
+    std::optional<PVec2> last_free {};
+    if (isFree(*world, last_free_[i])) {
+      last_free = last_free_[i];
+    }
+    std::optional<PVec2> hit {};
+    bool left_world = false;
+    while (auto next = path.Next()) {
+      if (!world->IsValidSquare(*next)) {
+        left_world = true;
+        break;
+      }
+      if (world->GetSquare(*next).is_occupied) {
+        hit = next;
+        break;
+      }
+      last_free = next;
+    }
+
+    if (hit) {
+      // A particle that was never in a free square that is still free is buried, and is pushed out to the nearest
+      // free square instead of passing through the terrain.
+      if (!last_free) {
+        last_free = findFreeSquareNear(*world, *hit, max_push_out);
+      }
+      if (last_free) {
+        Square square(true, color_[i], material_[i], behavior_[i]);
+        square.velocity = {vx_[i], vy_[i]};
+        world->SetSquare(last_free->x, last_free->y, square);
+      }
+      // With nowhere nearby to land, the particle is crushed.
+      removeParticle(i);
+    }
+    else if (left_world) {
+      removeParticle(i);
+    }
+    else {
+      if (last_free) {
+        last_free_[i] = *last_free;
+      }
+      ++i;
+    }
+  }
+}
+
+void ParticleSystem::_updatePhysics(float dt, const World* world) {
+  Node::_updatePhysics(dt, world);
+
+  const auto gravity = world ? world->GetGravity() : 0.f;
+  const auto count   = Size();
+
+  // Each loop is branch free over contiguous arrays, so the compiler can vectorize it.
+  std::copy(x_.begin(), x_.end(), last_x_.begin());
+  std::copy(y_.begin(), y_.end(), last_y_.begin());
+
+  float* vy = vy_.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    vy[i] += gravity * dt;
+  }
+
+  float* vx = vx_.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    vx[i] = std::clamp(vx[i], -max_speed_, max_speed_);
+    vy[i] = std::clamp(vy[i], -max_speed_, max_speed_);
+  }
+
+  float* x = x_.data();
+  float* y = y_.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+  }
+}
+
+void ParticleSystem::removeParticle(std::size_t index) {
+  auto remove = [index](auto& values) {
+    values[index] = values.back();
+    values.pop_back();
+  };
+  remove(x_);
+  remove(y_);
+  remove(vx_);
+  remove(vy_);
+  remove(last_x_);
+  remove(last_y_);
+  remove(last_free_);
+  remove(color_);
+  remove(material_);
+  remove(behavior_);
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::world {
+
+//! \brief Simulates squares that are flying through the air (splashes, debris, etc.) as free particles instead
+//!        of as squares swapping through the grid one step at a time.
+//!
+//! Particle state is stored as a structure of arrays, so integration is a few tight loops over contiguous
+//! floats. A particle moves freely until its path runs into an occupied square, at which point it is written
+//! back into the world, via SetSquare, at the last free square it passed through.
+//!
+//! The particle system should be a child of the world it belongs to, so it is handed that world.
+class ParticleSystem : public Node {
+public:
+  //! \param empty_square The square left behind when a square is ejected from the world.
+  explicit ParticleSystem(const Square& empty_square) : empty_square_(empty_square) {}
+
+  //! \brief Add a particle, with a position and velocity in squares and squares per second.
+  void AddParticle(Vec2 position, Vec2 velocity, const Square& square);
+
+  //! \brief Turn an occupied square of the world into a particle, leaving the empty square in its place.
+  //!        Returns false if there is no occupied square there.
+  bool Eject(World& world, long long x, long long y, Vec2 velocity);
+
+  [[nodiscard]] std::size_t Size() const { return x_.size(); }
+
+  [[nodiscard]] Vec2 GetPosition(std::size_t index) const { return {x_[index], y_[index]}; }
+  [[nodiscard]] Color GetColor(std::size_t index) const { return color_[index]; }
+
+  //! \brief Set the largest speed a particle can have in either direction, in squares per second.
+  void SetMaxSpeed(float max_speed) { max_speed_ = max_speed; }
+
+private:
+  //! \brief Land every particle whose path since the last update ran into something.
+  void _interactWithWorld(World* world) override;
+
+  //! \brief Integrate the motion of all particles.
+  void _updatePhysics(float dt, const World* world) override;
+
+  //! \brief Remove a particle by moving the last particle into its place.
+  void removeParticle(std::size_t index);
+
+  Square empty_square_;
+
+  float max_speed_ = 250.f;
+
+  // ===========================================================================
+  //  Particle state, one entry per particle.
+  // ===========================================================================
+
+  std::vector<float> x_, y_;
+  std::vector<float> vx_, vy_;
+
+  //! \brief Positions at the start of the last integration step, the start of the path that is checked.
+  std::vector<float> last_x_, last_y_;
+
+  //! \brief The last free square each particle was in, where it lands if its path starts inside occupied squares.
+  std::vector<PVec2> last_free_;
+
+  std::vector<Color> color_;
+  std::vector<const Material*> material_;
+  std::vector<const SquareBehavior*> behavior_;
+};
+
+}  // namespace pixelengine::world
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::world {
+
+//! \brief A pre-rasterized block of squares that can be blitted into a world.
+//!
+//! Squares are stored row by row, with row 0 at the bottom, the same as in the world. Only opaque squares are
+//! copied into the world; transparent squares leave the world as it was.
+class Prefab {
+public:
+  Prefab(std::size_t width, std::size_t height)
+      : width_(width)
+      , height_(height)
+      , squares_(width * height)
+      , is_opaque_(width * height, 0) {}
+
+  //! \brief Rasterize a prefab by calling `generator(x, y)` for every square. The generator returns an
+  //!        optional square, where nullopt means that the square is transparent.
+  template<typename Generator_t>
+  static Prefab Rasterize(std::size_t width, std::size_t height, Generator_t&& generator) {
+    Prefab prefab(width, height);
+    for (std::size_t y = 0; y < height; ++y) {
+      for (std::size_t x = 0; x < width; ++x) {
+        if (std::optional<Square> square = generator(x, y)) {
+          prefab.SetSquare(x, y, *square);
+        }
+      }
+    }
+    return prefab;
+  }
+
+  void SetSquare(std::size_t x, std::size_t y, const Square& square) {
+    squares_[y * width_ + x]   = square;
+    is_opaque_[y * width_ + x] = 1;
+  }
+
+  [[nodiscard]] std::size_t GetWidth() const { return width_; }
+  [[nodiscard]] std::size_t GetHeight() const { return height_; }
+
+  [[nodiscard]] const Square& GetSquare(std::size_t x, std::size_t y) const { return squares_[y * width_ + x]; }
+  [[nodiscard]] bool IsOpaque(std::size_t x, std::size_t y) const { return is_opaque_[y * width_ + x] != 0; }
+
+private:
+  std::size_t width_, height_;
+
+  std::vector<Square> squares_;
+
+  //! \brief Whether each square should be copied into the world.
+  std::vector<uint8_t> is_opaque_;
+};
+
+}  // namespace pixelengine::world
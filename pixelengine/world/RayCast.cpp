@@ -0,0 +1,83 @@
+#include "pixelengine/world/RayCast.h"
+// Other files.
+#include <numbers>
+
+namespace pixelengine::world {
+
+namespace {
+
+//! \brief How a square looks to a batch of rays.
+enum class RayCell : uint8_t {
+  open,
+  blocking,
+  outside,
+};
+
+//! \brief The largest region that CastRays will copy out of the world.
+constexpr long long max_snapshot_squares = 1 << 20;
+
+}  // namespace
+
+std::vector<RayHit> CastRays(const World& world, std::span<const RaySegment> rays) {
+  std::vector<RayHit> hits(rays.size());
+  if (rays.empty()) {
+    return hits;
+  }
+
+  // Find every square any of the rays could reach.
+  BoundingBox region;
+  for (auto& ray : rays) {
+    region.Update(static_cast<long long>(std::floor(ray.origin.x)), static_cast<long long>(std::floor(ray.origin.y)));
+    // A ray without a direction goes nowhere, and its direction cannot be normalized.
+    if (length(ray.direction) == 0.f) {
+      continue;
+    }
+    auto end = ray.origin + normalize(ray.direction) * ray.max_distance;
+    region.Update(static_cast<long long>(std::floor(end.x)), static_cast<long long>(std::floor(end.y)));
+  }
+  region.Expand(1);
+
+  // Very long rays would need a huge snapshot, just cast them against the world directly.
+  if (max_snapshot_squares < (region.x_max - region.x_min + 1) * (region.y_max - region.y_min + 1)) {
+    for (std::size_t i = 0; i < rays.size(); ++i) {
+      hits[i] = CastRay(world, rays[i]);
+    }
+    return hits;
+  }
+
+  RegionSnapshot<RayCell> cells(world, region, RayCell::outside, [blocks = BlocksRay {}](const Square& square) {
+    return blocks(square) ? RayCell::blocking : RayCell::open;
+  });
+
+  for (std::size_t i = 0; i < rays.size(); ++i) {
+    auto& ray = rays[i];
+    auto& hit = hits[i];
+    PVec2 previous {static_cast<long long>(std::floor(ray.origin.x)),
+                    static_cast<long long>(std::floor(ray.origin.y))};
+    TraverseGrid(ray.origin, ray.direction, ray.max_distance, [&](PVec2 square, float distance) {
+      switch (cells.Get(square.x, square.y)) {
+        case RayCell::outside:
+          return false;
+        case RayCell::blocking:
+          hit = {true, square, previous, distance};
+          return false;
+        case RayCell::open:
+          break;
+      }
+      previous = square;
+      return true;
+    });
+  }
+  return hits;
+}
+
+std::vector<RayHit> CastRadialRays(const World& world, Vec2 origin, std::size_t count, float max_distance) {
+  std::vector<RaySegment> rays(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto angle = 2.f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(count);
+    rays[i]    = {origin, {std::cos(angle), std::sin(angle)}, max_distance};
+  }
+  return CastRays(world, rays);
+}
+
+}  // namespace pixelengine::world
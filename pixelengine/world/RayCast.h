@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cmath>
+
+#include "pixelengine/world/World.h"
+
+namespace pixelengine::world {
+
+//! \brief A ray segment, in world (square) coordinates.
+struct RaySegment {
+  Vec2 origin;
+  //! \brief Direction of the ray, does not have to be normalized.
+  Vec2 direction;
+  float max_distance {};
+};
+
+//! \brief The result of casting a ray.
+struct RayHit {
+  //! \brief Whether the ray hit a blocking square before reaching its maximum distance or leaving the world.
+  bool is_hit = false;
+
+  //! \brief The square that was hit.
+  PVec2 square {};
+
+  //! \brief The last square the ray passed through before the square it hit.
+  PVec2 previous {};
+
+  //! \brief Distance along the ray to where it entered the hit square.
+  float distance = 0.f;
+};
+
+//! \brief The default test for whether a square stops a ray: occupied by a solid or powder.
+struct BlocksRay {
+  bool operator()(const Square& square) const {
+    return square.is_occupied && square.material->IsSolidOrPowder();
+  }
+};
+
+//! \brief Visit every square a ray passes through, in order, using integer DDA traversal of the grid.
+//!
+//! The origin and direction are converted to fixed point once, and every choice of which grid line the ray crosses
+//! next is made with exact integer arithmetic, so long rays do not drift off their line the way accumulated float
+//! distances do. The distance passed to the visitor is computed from scratch at every crossing.
+//!
+//! The visitor is called as `visitor(square, distance)`, where distance is how far along the ray the ray
+//! entered the square, and returns whether to keep going.
+template<typename Visitor_t>
+void TraverseGrid(Vec2 origin, Vec2 direction, float max_distance, Visitor_t&& visitor) {
+  // Positions are multiples of 2^-16 of a square, and direction components multiples of 2^-24, which keeps long
+  // rays within a small fraction of a square of their line. A distance in fixed point times a direction component
+  // fits in 64 bits for rays shorter than millions of squares.
+  constexpr int position_bits = 16, direction_bits = 24;
+
+  const auto ray_length = length(direction);
+  const long long origin_x = std::llround(std::ldexp(static_cast<double>(origin.x), position_bits));
+  const long long origin_y = std::llround(std::ldexp(static_cast<double>(origin.y), position_bits));
+  // Arithmetic shifts round towards negative infinity, to the square containing the point.
+  PVec2 square {origin_x >> position_bits, origin_y >> position_bits};
+  if (ray_length == 0.f) {
+    visitor(square, 0.f);
+    return;
+  }
+  const long long dx = std::llround(std::ldexp(static_cast<double>(direction.x / ray_length), direction_bits));
+  const long long dy = std::llround(std::ldexp(static_cast<double>(direction.y / ray_length), direction_bits));
+  const long long step_x = 0 < dx ? 1 : -1, step_y = 0 < dy ? 1 : -1;
+  const long long abs_dx = std::abs(dx), abs_dy = std::abs(dy);
+
+  // The next vertical and horizontal grid lines the ray crosses, in fixed point.
+  constexpr long long one = 1ll << position_bits;
+  long long next_x = (square.x + (0 < dx ? 1 : 0)) * one;
+  long long next_y = (square.y + (0 < dy ? 1 : 0)) * one;
+
+  // How far along the ray a grid line is, from the fixed point distance to it and the direction component.
+  auto distanceTo = [](long long offset, long long component) {
+    return static_cast<float>(std::ldexp(static_cast<double>(offset) / static_cast<double>(component),
+                                         direction_bits - position_bits));
+  };
+
+  // The distance to a grid line is |line - origin| / |d|, so the ray crosses a vertical line next exactly when
+  // |next_x - origin_x| * |dy| < |next_y - origin_y| * |dx|.
+  float t = 0.f;
+  while (t <= max_distance) {
+    if (!visitor(square, t)) {
+      return;
+    }
+    const auto to_x = std::abs(next_x - origin_x), to_y = std::abs(next_y - origin_y);
+    if (abs_dx != 0 && (abs_dy == 0 || to_x * abs_dy < to_y * abs_dx)) {
+      t = distanceTo(to_x, abs_dx);
+      square.x += step_x;
+      next_x += step_x * one;
+    }
+    else if (abs_dy != 0) {
+      t = distanceTo(to_y, abs_dy);
+      square.y += step_y;
+      next_y += step_y * one;
+    }
+    else {
+      // The direction is too short to represent in fixed point.
+      return;
+    }
+  }
+}
+
+//! \brief A copy of a per-square value over a rectangle of the world. Many queries over the same area can read
+//!        a flat array, instead of calling into the world for every square they touch.
+template<typename Value_t>
+class RegionSnapshot {
+public:
+  //! \brief Snapshot `func(square)` for every square in the region. Squares that are not valid, or not in the
+  //!        region, read as `outside`.
+  template<typename Func_t>
+  RegionSnapshot(const World& world, const BoundingBox& region, Value_t outside, Func_t&& func)
+      : region_(region)
+      , width_(region.IsEmpty() ? 0 : region.x_max - region.x_min + 1)
+      , outside_(outside) {
+    if (region.IsEmpty() || region.y_max < region.y_min) {
+      return;
+    }
+    values_.assign(static_cast<std::size_t>(width_ * (region.y_max - region.y_min + 1)), outside);
+    for (auto y = region.y_min; y <= region.y_max; ++y) {
+      auto* row_values = &values_[static_cast<std::size_t>((y - region.y_min) * width_)];
+      for (auto x = region.x_min; x <= region.x_max;) {
+        auto row = world.GetSquareRow(x, y, region.x_max - x + 1);
+        if (row.empty()) {
+          ++x;
+          continue;
+        }
+        for (auto& square : row) {
+          row_values[x - region.x_min] = func(square);
+          ++x;
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] Value_t Get(long long x, long long y) const {
+    if (!region_.Contains(x, y)) {
+      return outside_;
+    }
+    return values_[static_cast<std::size_t>((y - region_.y_min) * width_ + (x - region_.x_min))];
+  }
+
+  [[nodiscard]] const BoundingBox& GetRegion() const { return region_; }
+
+private:
+  BoundingBox region_;
+  long long width_;
+  Value_t outside_;
+  std::vector<Value_t> values_;
+};
+
+//! \brief Cast a single ray against the world, stopping at the first square that blocks it.
+template<typename Blocks_t = BlocksRay>
+RayHit CastRay(const World& world, const RaySegment& ray, Blocks_t&& blocks = {}) {
+  RayHit hit;
+  PVec2 previous {static_cast<long long>(std::floor(ray.origin.x)), static_cast<long long>(std::floor(ray.origin.y))};
+  TraverseGrid(ray.origin, ray.direction, ray.max_distance, [&](PVec2 square, float distance) {
+    if (!world.IsValidSquare(square)) {
+      return false;
+    }
+    if (blocks(world.GetSquare(square))) {
+      hit = {true, square, previous, distance};
+      return false;
+    }
+    previous = square;
+    return true;
+  });
+  return hit;
+}
+
+//! \brief Cast many rays at once, e.g. hundreds of rays from one explosion.
+//!
+//! The squares the rays could reach are read from the world once, a row at a time, and every ray is traversed
+//! over that copy. This is much faster than casting the rays one at a time when the rays are close together.
+std::vector<RayHit> CastRays(const World& world, std::span<const RaySegment> rays);
+
+//! \brief Cast `count` rays evenly spread around a circle, all from the same origin.
+std::vector<RayHit> CastRadialRays(const World& world, Vec2 origin, std::size_t count, float max_distance);
+
+}  // namespace pixelengine::world
@@ -5,6 +5,7 @@
 #include "pixelengine/world/World.h"
 // Other files.
 #include "pixelengine/utility/PathGenerator.h"
+#include "pixelengine/world/Prefab.h"
 
 namespace pixelengine::world {
 
@@ -20,6 +21,58 @@ void Square::UpdateKinematics(float dt, const World& world) {
   }
 }
 
+void World::Blit(const Prefab& prefab, PVec2 position) {
+  BoundingBox edited;
+  const auto width = static_cast<long long>(prefab.GetWidth());
+  for (std::size_t py = 0; py < prefab.GetHeight(); ++py) {
+    const auto y = position.y + static_cast<long long>(py);
+
+    // Copy each run of opaque squares as (at most a few) contiguous spans.
+    for (long long px = 0; px < width;) {
+      if (!prefab.IsOpaque(px, py)) {
+        ++px;
+        continue;
+      }
+      auto run_end = px;
+      for (; run_end < width && prefab.IsOpaque(run_end, py); ++run_end) {}
+
+      editRow(y, position.x + px, position.x + run_end - 1, [&](long long x, long long, Square& square) {
+        square = prefab.GetSquare(x - position.x, py);
+      }, edited);
+      px = run_end;
+    }
+  }
+  if (!edited.IsEmpty()) {
+    markEdited(edited);
+  }
+}
+
+SquareCounts World::CountSquares(const BoundingBox& region) const {
+  SquareCounts counts;
+  if (region.IsEmpty() || region.y_max < region.y_min) {
+    return counts;
+  }
+  for (auto y = region.y_min; y <= region.y_max; ++y) {
+    for (auto x = region.x_min; x <= region.x_max;) {
+      auto row = getSquareRow(x, y, region.x_max - x + 1);
+      if (row.empty()) {
+        // Squares outside of the world count as solid.
+        ++counts.solid;
+        ++x;
+        continue;
+      }
+      for (auto& square : row) {
+        if (square.is_occupied) {
+          counts.solid += square.material->IsSolidOrPowder();
+          counts.fluid += square.material->IsLiquidOrGas();
+        }
+      }
+      x += static_cast<long long>(row.size());
+    }
+  }
+  return counts;
+}
+
 bool attemptSwap(Square& square, long long x1, long long y1, World& world) {
   if (!world.IsValidSquare(x1, y1)) {
     return false;
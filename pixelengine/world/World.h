@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <span>
 #include <vector>
 
 #include <Lightning/Lightning.h>
@@ -19,6 +20,8 @@ namespace pixelengine::world {
 
 // Forward declare.
 class World;
+class Prefab;
+class ChangeTracker;
 
 
 //! \brief The phase of matter of a material.
@@ -45,6 +48,12 @@ struct Material {
   //! \brief The phase of matter of the material.
   PhaseOfMatter phase_of_matter = PhaseOfMatter::SOLID;
 
+  //! \brief How much light the material gives off, from 0 (none) to 1 (as bright as the sky).
+  float light_emission = 0.f;
+
+  //! \brief The fraction of full brightness that light loses passing through one square of the material.
+  float light_attenuation = 0.0625f;
+
   // ===========================================================================
   //  Convenience functions.
   // ===========================================================================
@@ -70,10 +79,13 @@ struct Material {
   [[nodiscard]] bool IsLiquidOrGas() const noexcept { return IsLiquid() || IsGas(); }
 };
 
-constexpr Material AIR {.phase_of_matter = PhaseOfMatter::GAS};
-constexpr Material SAND {.mass = 2.0, .is_rigid = false, .phase_of_matter = PhaseOfMatter::POWDER};
-constexpr Material WATER {.mass = 1.5, .is_rigid = false, .phase_of_matter = PhaseOfMatter::LIQUID};
-constexpr Material DIRT {.mass = 3.0, .is_rigid = true, .phase_of_matter = PhaseOfMatter::SOLID};
+inline constexpr Material AIR {.phase_of_matter = PhaseOfMatter::GAS};
+inline constexpr Material SAND {
+    .mass = 2.0, .is_rigid = false, .phase_of_matter = PhaseOfMatter::POWDER, .light_attenuation = 0.25f};
+inline constexpr Material WATER {
+    .mass = 1.5, .is_rigid = false, .phase_of_matter = PhaseOfMatter::LIQUID, .light_attenuation = 0.1f};
+inline constexpr Material DIRT {
+    .mass = 3.0, .is_rigid = true, .phase_of_matter = PhaseOfMatter::SOLID, .light_attenuation = 0.3f};
 
 
 //! \brief Class that represents how a square "behaves," i.e., its physical properties.
@@ -136,6 +148,30 @@ public:
   void DecreaseMoves() { num_moves = 0 < num_moves ? num_moves - 1 : 0; }
 };
 
+//! \brief The number of squares of each kind in a region.
+struct SquareCounts {
+  //! \brief Occupied squares that are solid or powder, the squares that block bodies. Squares outside of the world
+  //!        count as solid.
+  uint32_t solid = 0;
+
+  //! \brief Occupied squares that are liquid or gas.
+  uint32_t fluid = 0;
+
+  SquareCounts& operator+=(const SquareCounts& other) {
+    solid += other.solid;
+    fluid += other.fluid;
+    return *this;
+  }
+
+  friend SquareCounts operator+(SquareCounts a, const SquareCounts& b) { return a += b; }
+
+  friend SquareCounts operator-(SquareCounts a, const SquareCounts& b) {
+    a.solid -= b.solid;
+    a.fluid -= b.fluid;
+    return a;
+  }
+};
+
 //! brief The world interface. Allows for accessing pixels / squares, but doesn't put any requirements on
 //!       how the world is stored, cached, saved, updated, etc.
 class World : public Node {
@@ -149,14 +185,138 @@ public:
   [[nodiscard]] bool IsValidSquare(long long x, long long y) const { return isValidSquare(x, y); }
   [[nodiscard]] bool IsValidSquare(PVec2 vec) const { return isValidSquare(vec.x, vec.y); }
 
+  //! \brief Get a contiguous run of at most `count` squares in row y, starting at x. The run can be shorter than
+  //!        requested, and is empty if (x, y) is not a valid square. Useful for reading many squares at once.
+  [[nodiscard]] std::span<const Square> GetSquareRow(long long x, long long y, long long count) const {
+    return getSquareRow(x, y, count);
+  }
+
   [[nodiscard]] virtual float GetGravity() const = 0;
 
+  //! \brief Get the record of which parts of the world have changed, if the world keeps one.
+  [[nodiscard]] virtual const ChangeTracker* GetChangeTracker() const { return nullptr; }
+
+  //! \brief Count the solid and fluid squares in the (inclusive) rectangle, e.g. to check whether an area is clear.
+  //!        Worlds that can answer faster than by looking at every square should override this.
+  [[nodiscard]] virtual SquareCounts CountSquares(const BoundingBox& region) const;
+
+  // ===========================================================================
+  //  Bulk edits.
+  //
+  //  Bulk edits write whole rows of squares at a time, and notify the world that
+  //  the squares changed once per operation, instead of once per square.
+  //  The edit function is called as `edit(x, y, square)` for every valid square in
+  //  the shape, and modifies the square in place (leaving it alone is allowed).
+  // ===========================================================================
+
+  //! \brief Edit every square in the (inclusive) rectangle.
+  template<typename Edit_t>
+  void FillRectangle(const BoundingBox& region, Edit_t&& edit) {
+    BoundingBox edited;
+    for (auto y = region.y_min; y <= region.y_max; ++y) {
+      editRow(y, region.x_min, region.x_max, edit, edited);
+    }
+    if (!edited.IsEmpty()) {
+      markEdited(edited);
+    }
+  }
+
+  //! \brief Edit every square within `radius` of the center.
+  template<typename Edit_t>
+  void FillCircle(PVec2 center, long long radius, Edit_t&& edit) {
+    BoundingBox edited;
+    for (auto dy = -radius; dy <= radius; ++dy) {
+      auto half_width = static_cast<long long>(std::sqrt(static_cast<double>(radius * radius - dy * dy)));
+      editRow(center.y + dy, center.x - half_width, center.x + half_width, edit, edited);
+    }
+    if (!edited.IsEmpty()) {
+      markEdited(edited);
+    }
+  }
+
+  //! \brief Edit every square within `radius` of the line segment from start to end, e.g. to connect brush
+  //!        positions from consecutive frames.
+  template<typename Edit_t>
+  void StrokeLine(PVec2 start, PVec2 end, long long radius, Edit_t&& edit) {
+    const auto dx = static_cast<double>(end.x - start.x), dy = static_cast<double>(end.y - start.y);
+    const auto length_sqr = dx * dx + dy * dy;
+    const auto radius_sqr = static_cast<double>(radius * radius);
+
+    auto within = [&](long long x, long long y) {
+      auto px = static_cast<double>(x - start.x), py = static_cast<double>(y - start.y);
+      auto t  = length_sqr == 0. ? 0. : std::clamp((px * dx + py * dy) / length_sqr, 0., 1.);
+      auto ex = px - t * dx, ey = py - t * dy;
+      return ex * ex + ey * ey <= radius_sqr;
+    };
+
+    // The stroke is convex, so its intersection with each row is a single run of squares.
+    BoundingBox edited;
+    const auto x_min = std::min(start.x, end.x) - radius, x_max = std::max(start.x, end.x) + radius;
+    const auto y_min = std::min(start.y, end.y) - radius, y_max = std::max(start.y, end.y) + radius;
+    for (auto y = y_min; y <= y_max; ++y) {
+      auto first = x_min, last = x_max;
+      for (; first <= last && !within(first, y); ++first) {}
+      for (; first <= last && !within(last, y); --last) {}
+      if (first <= last) {
+        editRow(y, first, last, edit, edited);
+      }
+    }
+    if (!edited.IsEmpty()) {
+      markEdited(edited);
+    }
+  }
+
+  //! \brief Copy the opaque squares of a prefab into the world, with the prefab's bottom left corner at the
+  //!        position.
+  void Blit(const Prefab& prefab, PVec2 position);
+
 private:
+  //! \brief Apply an edit to every valid square in a row, a contiguous span at a time.
+  template<typename Edit_t>
+  void editRow(long long y, long long x_min, long long x_max, Edit_t&& edit, BoundingBox& edited) {
+    for (auto x = x_min; x <= x_max;) {
+      auto row = getSquareRow(x, y, x_max - x + 1);
+      if (row.empty()) {
+        ++x;
+        continue;
+      }
+      edited.Update(x, y);
+      for (auto& square : row) {
+        edit(x, y, square);
+        ++x;
+      }
+      edited.Update(x - 1, y);
+    }
+  }
+
   [[nodiscard]] virtual const Square& getSquare(long long x, long long y) const = 0;
   [[nodiscard]] virtual Square& getSquare(long long x, long long y)             = 0;
   virtual void setSquare(long long x, long long y, const Square& square)        = 0;
   [[nodiscard]] virtual bool isValidSquare(long long x, long long y) const      = 0;
 
+  //! \brief Get a contiguous run of at most `count` squares in row y, starting at x. The run may be shorter
+  //!        than requested (but not empty) if the world does not store the whole row contiguously. Returns an
+  //!        empty span if (x, y) is not a valid square.
+  [[nodiscard]] virtual std::span<Square> getSquareRow(long long x, long long y, [[maybe_unused]] long long count) {
+    if (!isValidSquare(x, y)) {
+      return {};
+    }
+    return {&getSquare(x, y), 1};
+  }
+
+  [[nodiscard]] virtual std::span<const Square> getSquareRow(long long x,
+                                                             long long y,
+                                                             [[maybe_unused]] long long count) const {
+    if (!isValidSquare(x, y)) {
+      return {};
+    }
+    return {&getSquare(x, y), 1};
+  }
+
+  //! \brief Called once after a bulk edit, with a bounding box around every square the edit could have
+  //!        changed. Worlds that track which squares need updates should override this.
+  virtual void markEdited([[maybe_unused]] const BoundingBox& region) {}
+
   // ===========================================================================
   //  Node overrides.
   // ===========================================================================
@@ -0,0 +1,82 @@
+#include "pixelengine/world/WorldGenerator.h"
+// Other files.
+#include "pixelengine/utility/Noise.h"
+
+namespace pixelengine::world {
+
+namespace {
+
+//! \brief Division that rounds towards negative infinity, so negative positions map to negative chunks.
+long long floorDivide(long long value, long long divisor) {
+  auto quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+}  // namespace
+
+void WorldGenerator::AddStage(std::unique_ptr<GenerationStage> stage) {
+  // Mix in the position too, so the same stages in a different order give a different fingerprint.
+  fingerprint_ = math::HashCoordinates(fingerprint_,
+                                       static_cast<long long>(stages_.size()),
+                                       static_cast<long long>(stage->GetFingerprint()));
+  stages_.push_back(std::move(stage));
+}
+
+Prefab WorldGenerator::GenerateChunk(PVec2 chunk) const {
+  if (cache_) {
+    if (auto cached = cache_->Load(seed_, fingerprint_, chunk, chunk_size_, chunk_size_)) {
+      return std::move(*cached);
+    }
+  }
+
+  Prefab prefab(chunk_size_, chunk_size_);
+  const auto size = static_cast<long long>(chunk_size_);
+  PVec2 origin {chunk.x * size, chunk.y * size};
+  for (auto& stage : stages_) {
+    stage->Apply(seed_, origin, prefab);
+  }
+
+  if (cache_) {
+    cache_->Store(seed_, fingerprint_, chunk, prefab);
+  }
+  return prefab;
+}
+
+std::future<Prefab> WorldGenerator::GenerateChunkAsync(PVec2 chunk, utility::JobSystem& jobs) const {
+  return jobs.Submit([this, chunk] { return GenerateChunk(chunk); });
+}
+
+std::vector<Prefab> WorldGenerator::GenerateChunks(std::span<const PVec2> chunks, utility::JobSystem& jobs) const {
+  std::vector<std::optional<Prefab>> generated(chunks.size());
+  jobs.ParallelFor(chunks.size(), [&](std::size_t i) { generated[i] = GenerateChunk(chunks[i]); });
+
+  std::vector<Prefab> prefabs;
+  prefabs.reserve(chunks.size());
+  for (auto& prefab : generated) {
+    prefabs.push_back(std::move(*prefab));
+  }
+  return prefabs;
+}
+
+void WorldGenerator::GenerateInto(World& world, const BoundingBox& region, utility::JobSystem& jobs) const {
+  if (region.IsEmpty()) {
+    return;
+  }
+  const auto size = static_cast<long long>(chunk_size_);
+
+  std::vector<PVec2> chunks;
+  for (auto cy = floorDivide(region.y_min, size); cy <= floorDivide(region.y_max, size); ++cy) {
+    for (auto cx = floorDivide(region.x_min, size); cx <= floorDivide(region.x_max, size); ++cx) {
+      chunks.emplace_back(cx, cy);
+    }
+  }
+
+  auto prefabs = GenerateChunks(chunks, jobs);
+
+  // Writing into the world happens on the calling thread.
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    world.Blit(prefabs[i], {chunks[i].x * size, chunks[i].y * size});
+  }
+}
+
+}  // namespace pixelengine::world
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <future>
+
+#include "pixelengine/utility/JobSystem.h"
+#include "pixelengine/world/ChunkCache.h"
+
+namespace pixelengine::world {
+
+//! \brief One stage of procedural world generation, e.g. terrain, caves, or ores.
+class GenerationStage {
+public:
+  virtual ~GenerationStage() = default;
+
+  //! \brief Apply the stage to the squares of a single chunk, whose bottom left square is at `origin` in the
+  //!        world.
+  //!
+  //! The result must only depend on the seed and the world positions of the squares (and what earlier stages
+  //! produced), and must be safe to call for several chunks at once from different threads.
+  virtual void Apply(uint64_t seed, PVec2 origin, Prefab& chunk) const = 0;
+
+  //! \brief Identifies the stage and its parameters. It must change whenever the stage would generate different
+  //!        squares, so chunks cached with an older configuration are not loaded.
+  [[nodiscard]] virtual uint64_t GetFingerprint() const = 0;
+};
+
+//! \brief Generates the world chunk by chunk, running every stage over each chunk in order.
+//!
+//! Chunks are generated independently, so they can be generated in parallel and in any order, and a chunk
+//! always comes out the same for the same seed and chunk coordinates. If a cache is set, generated chunks are
+//! stored on disk and loaded from there next time.
+class WorldGenerator {
+public:
+  WorldGenerator(uint64_t seed, std::size_t chunk_size) : seed_(seed), chunk_size_(chunk_size) {}
+
+  void AddStage(std::unique_ptr<GenerationStage> stage);
+
+  void SetCache(std::unique_ptr<ChunkCache> cache) { cache_ = std::move(cache); }
+
+  [[nodiscard]] uint64_t GetSeed() const { return seed_; }
+  [[nodiscard]] std::size_t GetChunkSize() const { return chunk_size_; }
+
+  //! \brief Identifies the stages, in order, and their parameters.
+  [[nodiscard]] uint64_t GetFingerprint() const { return fingerprint_; }
+
+  //! \brief Generate (or load) a single chunk on the calling thread.
+  [[nodiscard]] Prefab GenerateChunk(PVec2 chunk) const;
+
+  //! \brief Generate (or load) a chunk on the job system, e.g. to stream it in without stalling the frame.
+  [[nodiscard]] std::future<Prefab> GenerateChunkAsync(PVec2 chunk, utility::JobSystem& jobs) const;
+
+  //! \brief Generate (or load) a batch of chunks in parallel.
+  [[nodiscard]] std::vector<Prefab> GenerateChunks(std::span<const PVec2> chunks, utility::JobSystem& jobs) const;
+
+  //! \brief Generate every chunk that overlaps the region, in parallel, and blit the whole chunks into the
+  //!        world.
+  void GenerateInto(World& world, const BoundingBox& region, utility::JobSystem& jobs) const;
+
+private:
+  uint64_t seed_;
+
+  //! \brief The width and height of a chunk, in squares.
+  std::size_t chunk_size_;
+
+  std::vector<std::unique_ptr<GenerationStage>> stages_;
+
+  //! \brief Combined fingerprint of the stages, updated as they are added.
+  uint64_t fingerprint_ {};
+
+  std::unique_ptr<ChunkCache> cache_;
+};
+
+}  // namespace pixelengine::world